@@ -73,9 +73,11 @@ struct JSONV_PUBLIC compare_traits
     }
     
     /** Compare two string values. **/
-    static int compare_strings(const std::string& a, const std::string& b)
+    static int compare_strings(string_view a, string_view b)
     {
-        return a.compare(b);
+        return a == b ?  0
+             : a <  b ? -1
+             :           1;
     }
     
     /** Compare two strings used for the keys of objects. **/
@@ -143,7 +145,7 @@ int compare(const value& a, const value& b, const TCompareTraits& traits)
     case jsonv::kind::decimal:
         return traits.compare_decimals(a.as_decimal(), b.as_decimal());
     case jsonv::kind::string:
-        return traits.compare_strings(a.as_string(), b.as_string());
+        return traits.compare_strings(a.as_string_view(), b.as_string_view());
     case jsonv::kind::array:
     {
         auto aiter = a.begin_array();
@@ -33,7 +33,8 @@ namespace jsonv
  *     - Reasonable error messages when parsing fails
  *     - Full support for Unicode-filled JSON (encoded in UTF-8 in C++)
  *   - Efficient
- *     - Minimal overhead to store values (a `value` is 16 bytes on a 64-bit platform)
+ *     - Minimal overhead to store values (a `value` is 16 bytes on a 64-bit platform and strings of up to 14 characters
+ *       are stored inside of it)
  *     - No-throw move semantics wherever possible
  *   - Easy
  *     - Convert a `value` into a C++ type using `extract<T>`
@@ -155,7 +156,7 @@ namespace jsonv
  *  different iterator types in JSON Voorhees. They are aptly-named \c object_iterator and \c array_iterator. The access
  *  methods for these iterators are \c begin_object / \c end_object and \c begin_array / \c end_array, respectively.
  *  The object interface behaves exactly like you would expect a \c std::map<std::string,jsonv::value> to, while the
- *  array interface behaves just like a \c std::deque<jsonv::value> would.
+ *  array interface behaves just like a \c std::vector<jsonv::value> would.
  *  
  *  \code
  *  #include <jsonv/value.hpp>
@@ -724,14 +725,20 @@ namespace jsonv
 }
 
 #include "algorithm.hpp"
+#include "arena.hpp"
 #include "coerce.hpp"
 #include "config.hpp"
 #include "demangle.hpp"
+#include "document_reader.hpp"
 #include "encode.hpp"
 #include "forward.hpp"
 #include "functional.hpp"
+#include "lazy.hpp"
+#include "mapped_file.hpp"
+#include "ndjson.hpp"
 #include "parse.hpp"
 #include "path.hpp"
+#include "reader.hpp"
 #include "serialization.hpp"
 #include "serialization_builder.hpp"
 #include "serialization_util.hpp"
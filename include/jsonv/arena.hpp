@@ -0,0 +1,176 @@
+/** \file jsonv/arena.hpp
+ *  A region of memory for building \c value trees without allocating every node separately.
+ *
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#ifndef __JSONV_ARENA_HPP_INCLUDED__
+#define __JSONV_ARENA_HPP_INCLUDED__
+
+#include <jsonv/config.hpp>
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace jsonv
+{
+
+/** A monotonic memory region. Memory is handed out from large blocks by bumping a pointer and is only given back to the
+ *  system all at once, when the \c arena is destroyed or \c release is called.
+ *
+ *  An \c arena is used to hold an entire \c value tree, most commonly the result of
+ *  \c parse(const string_view&, arena&, const parse_options&). The array, object and string nodes of the tree and the
+ *  internal nodes of their containers are all allocated from the region, so building the tree takes one pointer bump
+ *  per node instead of a call to the heap. Those nodes are not freed one at a time; their memory is returned with the
+ *  rest of the region. Destroying the tree still visits every node to run its destructor, and long keys and strings
+ *  are freed on the heap as usual (see below), so it takes time proportional to the size of the tree. Releasing a tree
+ *  in constant time would need object keys which do not own their storage, but keys are exposed as \c std::string
+ *  through \c value::object_value_type, so that is not something an \c arena provides.
+ *
+ *  Values which live in an \c arena follow these rules:
+ *
+ *   - The \c arena must outlive every \c value which uses it. Destroying a \c value still runs the destructors of its
+ *     contents (see below), which touches the region.
+ *   - Copying a \c value always produces a tree on the regular heap, no matter where the source lives. Use a copy to
+ *     let a value escape the lifetime of its \c arena.
+ *   - Moving a \c value (or using \c swap) moves the node itself, so a value moved out of an arena tree into a heap
+ *     tree still lives in the \c arena. Moving heap values into an arena tree is safe -- they are destroyed as usual.
+ *   - Object keys and the contents of long strings are \c std::string instances. Keys short enough for the small
+ *     string optimization of \c std::string and strings short enough to be stored inside of a \c value live in the
+ *     region, but longer ones own a buffer on the heap. This is why destructors still run.
+ *
+ *  \warning
+ *  An \c arena is not thread-safe. It may be used from multiple threads only if access is externally synchronized.
+**/
+class JSONV_PUBLIC arena
+{
+public:
+    using size_type = std::size_t;
+
+public:
+    /** Create an empty region. No memory is allocated until the first call to \c allocate.
+     *
+     *  \param initial_block_size The size of the first block of memory to get. Each subsequent block is twice as large
+     *                            as the previous one (up to an upper limit).
+    **/
+    explicit arena(size_type initial_block_size = 16 * 1024);
+
+    arena(const arena&) = delete;
+    arena& operator=(const arena&) = delete;
+
+    /** Releases all the memory in this region. **/
+    ~arena() noexcept;
+
+    /** Get \a size bytes of memory aligned to \a alignment, which must be a power of 2. **/
+    void* allocate(size_type size, size_type alignment = alignof(std::max_align_t));
+
+    /** Give all memory back to the system. Any \c value still using this region is left dangling. **/
+    void release() noexcept;
+
+    /** The total number of bytes given out by \c allocate since construction or the last \c release. **/
+    size_type bytes_allocated() const;
+
+    /** The total number of bytes this region has gotten from the system. **/
+    size_type bytes_reserved() const;
+
+private:
+    struct block;
+
+private:
+    block*    _blocks;
+    char*     _cursor;
+    char*     _limit;
+    size_type _next_block_size;
+    size_type _allocated;
+    size_type _reserved;
+};
+
+namespace detail
+{
+
+/** A standard allocator which gets memory from an \c arena if it has one and from the heap if it does not. Memory from
+ *  an \c arena is never deallocated individually. Copies of a container using this allocator are made on the heap, so
+ *  copying a \c value can never create new references to an \c arena.
+**/
+template <typename T>
+class arena_allocator
+{
+public:
+    using value_type = T;
+
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap            = std::true_type;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = arena_allocator<U>;
+    };
+
+public:
+    arena_allocator() noexcept :
+            _region(nullptr)
+    { }
+
+    explicit arena_allocator(arena* region) noexcept :
+            _region(region)
+    { }
+
+    template <typename U>
+    arena_allocator(const arena_allocator<U>& source) noexcept :
+            _region(source.region())
+    { }
+
+    T* allocate(std::size_t count)
+    {
+        if (_region)
+            return static_cast<T*>(_region->allocate(count * sizeof(T), alignof(T)));
+        else
+            return static_cast<T*>(::operator new(count * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, std::size_t) noexcept
+    {
+        if (!_region)
+            ::operator delete(ptr);
+    }
+
+    arena_allocator select_on_container_copy_construction() const noexcept
+    {
+        return arena_allocator();
+    }
+
+    /** The \c arena this allocator gets memory from or \c nullptr for the heap. **/
+    arena* region() const noexcept
+    {
+        return _region;
+    }
+
+    template <typename U>
+    bool operator==(const arena_allocator<U>& other) const noexcept
+    {
+        return _region == other.region();
+    }
+
+    template <typename U>
+    bool operator!=(const arena_allocator<U>& other) const noexcept
+    {
+        return _region != other.region();
+    }
+
+private:
+    arena* _region;
+};
+
+}
+
+}
+
+#endif/*__JSONV_ARENA_HPP_INCLUDED__*/
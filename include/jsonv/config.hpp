@@ -139,6 +139,18 @@
 #   endif
 #endif
 
+/** \def JSONV_OBJECT_USE_FLAT_MAP
+ *  \brief Should values with \c kind::object keep their members in a sorted vector instead of a \c std::map?
+ *  A flat layout keeps the members in one sorted array, which avoids an allocation per member and makes lookups cheaper
+ *  for small objects, the most common kind in JSON documents. The trade-off is that inserting or erasing a member is
+ *  linear in the size of the object and invalidates iterators and references to the other members of that object.
+ *  
+ *  Keep in mind this value is \e always defined and must be the same for the library and everything that uses it.
+**/
+#ifndef JSONV_OBJECT_USE_FLAT_MAP
+#   define JSONV_OBJECT_USE_FLAT_MAP 0
+#endif
+
 /** \def JSONV_INTEGER_ALTERNATES_LIST
  *  \brief An item list of types to also consider as an integer.
  *  This mostly exists to help resolve the C-induced type ambiguity for the literal \c 0. It most prefers to be an
@@ -0,0 +1,487 @@
+/** \file jsonv/detail/flat_map.hpp
+ *  Definition of \c flat_map, an associative container backed by a sorted array.
+ *
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#ifndef __JSONV_DETAIL_FLAT_MAP_HPP_INCLUDED__
+#define __JSONV_DETAIL_FLAT_MAP_HPP_INCLUDED__
+
+#include <jsonv/config.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace jsonv
+{
+namespace detail
+{
+
+/** An associative container with the interface of \c std::map, but which keeps its elements in one array sorted by key.
+ *  Lookups are a binary search over contiguous memory and there is no allocation per element, which makes it a good fit
+ *  for the small objects common in JSON documents. Inserting or erasing is linear in the size of the container and
+ *  invalidates iterators and references to elements after the affected position.
+ *
+ *  The elements are real <tt>std::pair<const TKey, TValue></tt> objects, which is what the iterators hand out. Since
+ *  the key of one can not be assigned to or moved from, elements are moved around the array by constructing a new pair
+ *  in the destination (copying the key and moving the value) and destroying the old one. This is why \c flat_map
+ *  manages its own array instead of using a \c std::vector, which needs assignable elements. Keys short enough for the
+ *  small string optimization of \c std::string, which are most JSON keys, are about as cheap to copy as to move.
+ *
+ *  Moving an element can throw if copying its key does. The map is then left valid, but the elements which were being
+ *  moved may have been dropped or left with a moved-from value, unlike \c std::map, which never moves its elements.
+**/
+template <typename TKey, typename TValue, typename TCompare, typename TAllocator>
+class flat_map
+{
+public:
+    using key_type       = TKey;
+    using mapped_type    = TValue;
+    using value_type     = std::pair<const TKey, TValue>;
+    using key_compare    = TCompare;
+    using allocator_type = TAllocator;
+    using size_type      = std::size_t;
+
+    /** The type taken by \c insert. The key is not \c const, so it can be moved into the new element. **/
+    using insert_type    = std::pair<TKey, TValue>;
+
+private:
+    using element_allocator = typename std::allocator_traits<TAllocator>::template rebind_alloc<value_type>;
+    using element_traits    = std::allocator_traits<element_allocator>;
+
+public:
+    template <typename T>
+    class basic_iterator :
+            public std::iterator<std::bidirectional_iterator_tag, T>
+    {
+    public:
+        basic_iterator() = default;
+
+        /** This allows conversion from an \c iterator to a \c const_iterator. **/
+        template <typename U>
+        basic_iterator(const basic_iterator<U>& source,
+                       typename std::enable_if<std::is_convertible<U*, T*>::value>::type* = 0
+                      ) :
+                _ptr(source._ptr)
+        { }
+
+        basic_iterator& operator++()
+        {
+            ++_ptr;
+            return *this;
+        }
+
+        basic_iterator operator++(int)
+        {
+            basic_iterator clone(*this);
+            ++_ptr;
+            return clone;
+        }
+
+        basic_iterator& operator--()
+        {
+            --_ptr;
+            return *this;
+        }
+
+        basic_iterator operator--(int)
+        {
+            basic_iterator clone(*this);
+            --_ptr;
+            return clone;
+        }
+
+        template <typename U>
+        bool operator==(const basic_iterator<U>& other) const
+        {
+            return _ptr == other._ptr;
+        }
+
+        template <typename U>
+        bool operator!=(const basic_iterator<U>& other) const
+        {
+            return _ptr != other._ptr;
+        }
+
+        T& operator*() const
+        {
+            return *_ptr;
+        }
+
+        T* operator->() const
+        {
+            return _ptr;
+        }
+
+    private:
+        template <typename U>
+        friend class basic_iterator;
+
+        friend class flat_map;
+
+        explicit basic_iterator(T* ptr) :
+                _ptr(ptr)
+        { }
+
+    private:
+        T* _ptr = nullptr;
+    };
+
+    using iterator       = basic_iterator<value_type>;
+    using const_iterator = basic_iterator<const value_type>;
+
+public:
+    flat_map() = default;
+
+    explicit flat_map(const key_compare& compare, const allocator_type& alloc = allocator_type()) :
+            _compare(compare),
+            _alloc(alloc)
+    { }
+
+    flat_map(const flat_map& source) :
+            _compare(source._compare),
+            _alloc(element_traits::select_on_container_copy_construction(source._alloc))
+    {
+        try
+        {
+            copy_elements(source);
+        }
+        catch (...)
+        {
+            release();
+            throw;
+        }
+    }
+
+    flat_map(flat_map&& source) noexcept :
+            _compare(std::move(source._compare)),
+            _alloc(std::move(source._alloc)),
+            _data(source._data),
+            _size(source._size),
+            _capacity(source._capacity)
+    {
+        source.forget();
+    }
+
+    flat_map& operator=(const flat_map& source)
+    {
+        if (this != &source)
+        {
+            clear();
+            _compare = source._compare;
+            copy_elements(source);
+        }
+        return *this;
+    }
+
+    flat_map& operator=(flat_map&& source)
+    {
+        if (this == &source)
+            return *this;
+
+        release();
+        _compare = std::move(source._compare);
+        if (element_traits::propagate_on_container_move_assignment::value)
+            _alloc = source._alloc;
+
+        if (_alloc == source._alloc)
+        {
+            _data     = source._data;
+            _size     = source._size;
+            _capacity = source._capacity;
+            source.forget();
+        }
+        else
+        {
+            // The array of source can not be freed by our allocator, so the elements have to be moved into a new one
+            reserve(source._size);
+            for ( ; _size < source._size; ++_size)
+                element_traits::construct(_alloc, _data + _size, std::move(source._data[_size]));
+            source.clear();
+        }
+        return *this;
+    }
+
+    ~flat_map() noexcept
+    {
+        release();
+    }
+
+    iterator       begin()        { return iterator(_data); }
+    const_iterator begin()  const { return const_iterator(_data); }
+    const_iterator cbegin() const { return begin(); }
+    iterator       end()          { return iterator(_data + _size); }
+    const_iterator end()    const { return const_iterator(_data + _size); }
+    const_iterator cend()   const { return end(); }
+
+    bool      empty() const { return _size == 0; }
+    size_type size()  const { return _size; }
+
+    void clear() noexcept
+    {
+        destroy_range(0, _size);
+        _size = 0;
+    }
+
+    /** Make room for \a count elements, so inserting up to that many does not move the existing ones. **/
+    void reserve(size_type count)
+    {
+        if (count > _capacity)
+            reallocate(count, _size, nullptr);
+    }
+
+    iterator find(const key_type& key)
+    {
+        size_type idx = lower_bound_index(key);
+        return iterator(is_match(idx, key) ? _data + idx : _data + _size);
+    }
+
+    const_iterator find(const key_type& key) const
+    {
+        return const_iterator(const_cast<flat_map&>(*this).find(key)._ptr);
+    }
+
+    size_type count(const key_type& key) const
+    {
+        return find(key) == end() ? 0 : 1;
+    }
+
+    mapped_type& at(const key_type& key)
+    {
+        auto iter = find(key);
+        if (iter == end())
+            throw std::out_of_range("flat_map::at");
+        return iter->second;
+    }
+
+    const mapped_type& at(const key_type& key) const
+    {
+        return const_cast<flat_map&>(*this).at(key);
+    }
+
+    mapped_type& operator[](const key_type& key)
+    {
+        return insert(insert_type(key, mapped_type())).first->second;
+    }
+
+    mapped_type& operator[](key_type&& key)
+    {
+        return insert(insert_type(std::move(key), mapped_type())).first->second;
+    }
+
+    std::pair<iterator, bool> insert(insert_type item)
+    {
+        size_type idx = lower_bound_index(item.first);
+        if (is_match(idx, item.first))
+            return { iterator(_data + idx), false };
+        else
+            return { insert_at(idx, std::move(item)), true };
+    }
+
+    /** Insert the \a item, checking if \a hint is the correct position before searching. When building an object from
+     *  sorted keys, \c end() is always the correct hint, which makes construction linear.
+    **/
+    iterator insert(const_iterator hint, insert_type item)
+    {
+        size_type idx = index_of(hint);
+        if (  (idx == _size || _compare(item.first, _data[idx].first))
+           && (idx == 0     || _compare(_data[idx - 1].first, item.first))
+           )
+            return insert_at(idx, std::move(item));
+        else
+            return insert(std::move(item)).first;
+    }
+
+    size_type erase(const key_type& key)
+    {
+        auto iter = find(key);
+        if (iter == end())
+            return 0;
+
+        erase(iter);
+        return 1;
+    }
+
+    iterator erase(const_iterator position)
+    {
+        return erase(position, std::next(position));
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        size_type first_idx = index_of(first);
+        size_type last_idx  = index_of(last);
+        if (first_idx == last_idx)
+            return iterator(_data + first_idx);
+
+        size_type dest = first_idx;
+        try
+        {
+            for (size_type src = last_idx; src < _size; ++src, ++dest)
+            {
+                element_traits::destroy(_alloc, _data + dest);
+                element_traits::construct(_alloc, _data + dest, std::move(_data[src]));
+            }
+        }
+        catch (...)
+        {
+            // _data[dest] was destroyed, but not replaced
+            abandon_from(dest);
+            throw;
+        }
+        destroy_range(dest, _size);
+        _size = dest;
+        return iterator(_data + first_idx);
+    }
+
+private:
+    size_type index_of(const_iterator iter) const
+    {
+        return size_type(iter._ptr - _data);
+    }
+
+    size_type lower_bound_index(const key_type& key) const
+    {
+        const value_type* place = std::lower_bound(_data, _data + _size, key,
+                                                   [this] (const value_type& elem, const key_type& k)
+                                                   {
+                                                       return _compare(elem.first, k);
+                                                   }
+                                                  );
+        return size_type(place - _data);
+    }
+
+    bool is_match(size_type idx, const key_type& key) const
+    {
+        return idx != _size && !_compare(key, _data[idx].first);
+    }
+
+    iterator insert_at(size_type idx, insert_type&& item)
+    {
+        if (_size == _capacity)
+        {
+            reallocate(std::max<size_type>(4, _capacity * 2), idx, &item);
+            return iterator(_data + idx);
+        }
+
+        if (idx == _size)
+        {
+            element_traits::construct(_alloc, _data + _size, std::move(item.first), std::move(item.second));
+            ++_size;
+            return iterator(_data + idx);
+        }
+
+        // Open a gap at idx by moving everything after it one place toward the end, starting from the back
+        element_traits::construct(_alloc, _data + _size, std::move(_data[_size - 1]));
+        ++_size;
+        size_type dest = _size - 2;
+        try
+        {
+            for ( ; dest > idx; --dest)
+            {
+                element_traits::destroy(_alloc, _data + dest);
+                element_traits::construct(_alloc, _data + dest, std::move(_data[dest - 1]));
+            }
+            element_traits::destroy(_alloc, _data + idx);
+            element_traits::construct(_alloc, _data + idx, std::move(item.first), std::move(item.second));
+        }
+        catch (...)
+        {
+            // _data[dest] was destroyed, but not replaced
+            abandon_from(dest);
+            throw;
+        }
+        return iterator(_data + idx);
+    }
+
+    /** Move the elements into a new array of \a capacity elements. If \a item is not \c nullptr, it is inserted at
+     *  \a idx on the way. If anything throws, the old array is kept.
+    **/
+    void reallocate(size_type capacity, size_type idx, insert_type* item)
+    {
+        value_type* data  = element_traits::allocate(_alloc, capacity);
+        size_type   built = 0;
+        try
+        {
+            for ( ; built < idx; ++built)
+                element_traits::construct(_alloc, data + built, std::move(_data[built]));
+            if (item)
+            {
+                element_traits::construct(_alloc, data + idx, std::move(item->first), std::move(item->second));
+                ++built;
+            }
+            for (size_type src = idx; src < _size; ++src, ++built)
+                element_traits::construct(_alloc, data + built, std::move(_data[src]));
+        }
+        catch (...)
+        {
+            for (size_type pos = 0; pos < built; ++pos)
+                element_traits::destroy(_alloc, data + pos);
+            element_traits::deallocate(_alloc, data, capacity);
+            throw;
+        }
+
+        size_type size = _size + (item ? 1 : 0);
+        release();
+        _data     = data;
+        _size     = size;
+        _capacity = capacity;
+    }
+
+    void copy_elements(const flat_map& source)
+    {
+        reserve(source._size);
+        for ( ; _size < source._size; ++_size)
+            element_traits::construct(_alloc, _data + _size, source._data[_size]);
+    }
+
+    void destroy_range(size_type first, size_type last) noexcept
+    {
+        for (size_type idx = first; idx < last; ++idx)
+            element_traits::destroy(_alloc, _data + idx);
+    }
+
+    /** After a failed move, \c _data[idx] has already been destroyed and the elements after it are lost. **/
+    void abandon_from(size_type idx) noexcept
+    {
+        destroy_range(idx + 1, _size);
+        _size = idx;
+    }
+
+    void release() noexcept
+    {
+        clear();
+        if (_data)
+            element_traits::deallocate(_alloc, _data, _capacity);
+        forget();
+    }
+
+    void forget() noexcept
+    {
+        _data     = nullptr;
+        _size     = 0;
+        _capacity = 0;
+    }
+
+private:
+    key_compare       _compare;
+    element_allocator _alloc;
+    value_type*       _data     = nullptr;
+    size_type         _size     = 0;
+    size_type         _capacity = 0;
+};
+
+}
+}
+
+#endif/*__JSONV_DETAIL_FLAT_MAP_HPP_INCLUDED__*/
@@ -0,0 +1,87 @@
+/** \file jsonv/document_reader.hpp
+ *  Reading a series of JSON documents which follow one another in the same input.
+ *
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#ifndef __JSONV_DOCUMENT_READER_HPP_INCLUDED__
+#define __JSONV_DOCUMENT_READER_HPP_INCLUDED__
+
+#include <jsonv/config.hpp>
+#include <jsonv/parse.hpp>
+#include <jsonv/string_view.hpp>
+#include <jsonv/value.hpp>
+
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+
+namespace jsonv
+{
+
+/** Reads JSON documents which are written back to back in one input, like the output of \c "jq -c" or a connection
+ *  which carries a series of messages. The documents can be separated by whitespace (and comments, if the
+ *  \c parse_options allow them) or not separated at all, as in \c "{\"a\":1}{\"b\":2}". Numbers and literals which
+ *  follow one another need whitespace between them, since \c "12" is a single number.
+ *  
+ *  All the documents are read from a single \c tokenizer. When reading from an \c std::istream, it only keeps the
+ *  document being parsed in memory. Each document ends where its value does, so \c parse_options::complete_parse is
+ *  ignored; \c parse_options::require_document applies to each document. The first problem in a document is always
+ *  thrown as a \c parse_error, no matter the \c parse_options::failure_mode, with its position counted from the start
+ *  of the input. After a \c parse_error, reading can not go on, since there is no telling where the bad document ends.
+ *  
+ *  \example "document_reader"
+ *  \code
+ *  jsonv::document_reader documents(socket_stream);
+ *  jsonv::value message;
+ *  while (documents.next(message))
+ *      handle(message);
+ *  \endcode
+**/
+class JSONV_PUBLIC document_reader
+{
+public:
+    using size_type = std::size_t;
+    
+public:
+    /** Read documents from tokens of \a input. The \a input must outlive this instance. **/
+    explicit document_reader(tokenizer& input, const parse_options& options = parse_options());
+    
+    /** Read documents from \a input as they are requested. The stream must outlive this instance. **/
+    explicit document_reader(std::istream& input, const parse_options& options = parse_options());
+    
+    /** Read documents from the non-owned \a input. **/
+    explicit document_reader(string_view input, const parse_options& options = parse_options());
+    
+    document_reader(const document_reader&) = delete;
+    document_reader& operator=(const document_reader&) = delete;
+    
+    ~document_reader() noexcept;
+    
+    /** Read the next document into \a out.
+     *  
+     *  \returns \c true if a document was read; \c false if the input has ended.
+     *  \throws parse_error if the next document is not valid JSON.
+     *  \throws std::logic_error if a previous call threw a \c parse_error.
+    **/
+    bool next(value& out);
+    
+    /** Get the number of documents which have been read. **/
+    size_type count() const;
+    
+private:
+    std::unique_ptr<tokenizer> _owned_input;
+    tokenizer&                 _input;
+    parse_options              _options;
+    size_type                  _count;
+    bool                       _failed;
+};
+
+}
+
+#endif/*__JSONV_DOCUMENT_READER_HPP_INCLUDED__*/
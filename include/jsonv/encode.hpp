@@ -16,7 +16,10 @@
 #include <jsonv/forward.hpp>
 #include <jsonv/string_view.hpp>
 
+#include <cstddef>
 #include <iosfwd>
+#include <memory>
+#include <string>
 
 namespace jsonv
 {
@@ -246,6 +249,171 @@ private:
     bool          _defer_indent;
 };
 
+/** An encoder which appends to a contiguous buffer of characters, without going through an \c std::ostream. The
+ *  output is the same as from \c ostream_encoder, but writing it is much cheaper. The buffer is either owned by the
+ *  encoder and grows as needed or is a fixed span of memory given to the constructor.
+ *  
+ *  The buffer keeps its capacity when it is \c clear ed, so an instance which is kept around to encode many values
+ *  (like the responses of a server) stops allocating once its buffer is large enough for them.
+ *  
+ *  \example "buffer_encoder"
+ *  \code
+ *  jsonv::buffer_encoder encoder;
+ *  for (const jsonv::value& response : responses)
+ *  {
+ *      encoder.clear();
+ *      jsonv::string_view body = encoder.encode(response);
+ *      socket.send(body.data(), body.size());
+ *  }
+ *  \endcode
+**/
+class JSONV_PUBLIC buffer_encoder :
+        public encoder
+{
+public:
+    using size_type = std::size_t;
+    
+public:
+    /** Create an instance which appends to a buffer it owns. **/
+    buffer_encoder();
+    
+    /** Create an instance which appends to the \a capacity characters at \a data, which must outlive this instance. The
+     *  buffer does not grow -- output which would not fit throws an \c std::length_error.
+    **/
+    buffer_encoder(char* data, size_type capacity);
+    
+    buffer_encoder(const buffer_encoder&) = delete;
+    buffer_encoder& operator=(const buffer_encoder&) = delete;
+    
+    virtual ~buffer_encoder() noexcept;
+    
+    /** \see ostream_encoder::ensure_ascii **/
+    void ensure_ascii(bool value);
+    
+    /** Append the encoding of \a source to the buffer.
+     *  
+     *  \returns All of the text in the buffer. It is only valid until the buffer is changed.
+     *  \throws std::length_error if the buffer is a fixed span and the output does not fit in it. The text which did
+     *                            fit is kept, so the buffer holds a partial encoding until it is \c clear ed.
+    **/
+    string_view encode(const value& source);
+    
+    /** Get all of the text in the buffer. **/
+    string_view text() const;
+    
+    size_type size() const;
+    
+    size_type capacity() const;
+    
+    /** Remove all of the text from the buffer, keeping its capacity. **/
+    void clear();
+    
+    /** Make sure the buffer has room for at least \a capacity characters.
+     *  
+     *  \throws std::length_error if the buffer is a fixed span smaller than \a capacity.
+    **/
+    void reserve(size_type capacity);
+    
+protected:
+    virtual void write_null() override;
+    
+    virtual void write_object_begin() override;
+    
+    virtual void write_object_end() override;
+    
+    virtual void write_object_key(string_view key) override;
+    
+    virtual void write_object_delimiter() override;
+    
+    virtual void write_array_begin() override;
+    
+    virtual void write_array_end() override;
+    
+    virtual void write_array_delimiter() override;
+    
+    virtual void write_string(string_view value) override;
+    
+    virtual void write_integer(std::int64_t value) override;
+    
+    /** When a special value is given, this will output \c null. **/
+    virtual void write_decimal(double value) override;
+    
+    virtual void write_boolean(bool value) override;
+    
+protected:
+    /** Append the \a size characters at \a text to the buffer. **/
+    void append(const char* text, size_type size);
+    
+    void append(char c);
+    
+private:
+    std::unique_ptr<char[]> _owned;    //!< The storage of the buffer when it is not a fixed span
+    char*                   _data;
+    size_type               _size;
+    size_type               _capacity;
+    bool                    _fixed;
+    bool                    _ensure_ascii;
+};
+
+/** Encodes a value a chunk at a time, so the start of a large document can be sent before the rest of it is encoded.
+ *  Each call to \c next_chunk does only as much work as it takes to fill one chunk, which makes it fit into an event
+ *  loop: a huge \c value does not block the loop, and the memory used is proportional to the chunk size instead of the
+ *  size of the output. The concatenation of the chunks is the same as the output of \c ostream_encoder.
+ *  
+ *  The tree is walked with an explicit stack instead of recursion, so the state is kept between calls. Long strings are
+ *  split across chunks, too.
+ *  
+ *  \example "chunked_encoder"
+ *  \code
+ *  jsonv::chunked_encoder encoder(response_body);
+ *  std::string chunk;
+ *  while (encoder.next_chunk(chunk))
+ *      connection.write_chunk(chunk);
+ *  \endcode
+**/
+class JSONV_PUBLIC chunked_encoder
+{
+public:
+    using size_type = std::size_t;
+    
+public:
+    /** Create an instance which encodes \a source in chunks of \a chunk_size characters. \a source must outlive this
+     *  instance and must not be changed until the encoding is done.
+    **/
+    explicit chunked_encoder(const value& source, size_type chunk_size = 16 * 1024);
+    
+    chunked_encoder(const chunked_encoder&) = delete;
+    chunked_encoder& operator=(const chunked_encoder&) = delete;
+    
+    ~chunked_encoder() noexcept;
+    
+    /** \see ostream_encoder::ensure_ascii
+     *  
+     *  \note
+     *  This should be set before the first call to \c next_chunk.
+    **/
+    void ensure_ascii(bool value);
+    
+    size_type chunk_size() const;
+    
+    /** Replace the contents of \a out with the next chunk of output. Every chunk except the last one has exactly
+     *  \c chunk_size characters. The capacity of \a out is reused, so passing the same string each time does not
+     *  allocate after the first chunk.
+     *  
+     *  \returns \c true if a chunk was written; \c false if the encoding is done (in which case \a out is empty).
+    **/
+    bool next_chunk(std::string& out);
+    
+    /** Check if all of the output has been given out by \c next_chunk. **/
+    bool done() const;
+    
+private:
+    class impl;
+    
+private:
+    std::unique_ptr<impl> _impl;
+};
+
 }
 
 #endif/*__JSONV_ENCODE_HPP_INCLUDED__*/
@@ -15,6 +15,7 @@ namespace jsonv
 {
 
 class adapter;
+class arena;
 template <typename T> class adapter_builder;
 class encoder;
 class extractor;
@@ -0,0 +1,251 @@
+/** \file jsonv/lazy.hpp
+ *  A read-only view of JSON text which only decodes the parts of it that are looked at.
+ *
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#ifndef __JSONV_LAZY_HPP_INCLUDED__
+#define __JSONV_LAZY_HPP_INCLUDED__
+
+#include <jsonv/config.hpp>
+#include <jsonv/parse.hpp>
+#include <jsonv/path.hpp>
+#include <jsonv/string_view.hpp>
+#include <jsonv/value.hpp>
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace jsonv
+{
+
+namespace detail
+{
+
+struct lazy_index;
+
+}
+
+/** A value in a \c lazy_document. This behaves like a const \c value, but it is only a reference into the document's
+ *  index: nothing is decoded until it is asked for. Strings are decoded and numbers are converted the first time they
+ *  are accessed, and the result is kept in the document for later accesses. To get a real \c value for part of the
+ *  document, use \c materialize.
+ *  
+ *  Looking up an element of an array takes constant time. Looking up a key compares it with each key of a small
+ *  object; for a larger one, the first lookup builds a hash table of its keys, which later lookups use.
+ *  
+ *  A \c lazy_value is only valid as long as the \c lazy_document it came from.
+**/
+class JSONV_PUBLIC lazy_value
+{
+public:
+    using size_type = std::size_t;
+    
+    class array_iterator;
+    class object_iterator;
+    
+public:
+    /** Get the kind this value would have after \c materialize. **/
+    jsonv::kind kind() const;
+    
+    bool is_null() const;
+    
+    /** Get the number of elements of an array, members of an object or characters of a decoded string.
+     *  
+     *  \throws kind_error if this is not an array, object or string.
+    **/
+    size_type size() const;
+    
+    /** Get the element at \a idx of an array.
+     *  
+     *  \throws kind_error if this is not an array.
+     *  \throws std::out_of_range if \a idx is not less than \c size.
+    **/
+    lazy_value at(size_type idx) const;
+    
+    /** Get the value of \a key in an object. If the key appears more than once, this is the first one.
+     *  
+     *  \throws kind_error if this is not an object.
+     *  \throws std::out_of_range if there is no such key.
+    **/
+    lazy_value at(string_view key) const;
+    
+    /** \returns \c 1 if the object has \a key; \c 0 otherwise.
+     *  \throws kind_error if this is not an object.
+    **/
+    size_type count(string_view key) const;
+    
+    /** Get the value specified by the path \a p. This follows the same rules as \c value::at_path.
+     *  
+     *  \throws std::out_of_range if any path along the chain did not exist.
+     *  \throws kind_error if the path traversal is not valid for the value.
+    **/
+    lazy_value at_path(const path& p) const;
+    lazy_value at_path(string_view p) const;
+    lazy_value at_path(size_type   p) const;
+    
+    /** Like \c value::count_path, check if the path \a p leads to a value. **/
+    size_type count_path(const path& p) const;
+    size_type count_path(string_view p) const;
+    size_type count_path(size_type   p) const;
+    
+    /** Decode this string. The result is kept by the document, so it is valid for as long as the document is.
+     *  
+     *  \throws kind_error if this is not a string.
+     *  \throws parse_error if the string can not be decoded.
+    **/
+    const std::string& as_string() const;
+    
+    /** \throws kind_error if this is not an integer. **/
+    std::int64_t as_integer() const;
+    
+    /** Get this number as a \c double. Like \c value::as_decimal, this also works for integers.
+     *  
+     *  \throws kind_error if this is not a number.
+    **/
+    double as_decimal() const;
+    
+    /** \throws kind_error if this is not a boolean. **/
+    bool as_boolean() const;
+    
+    /** Get the JSON text of this value in the input of the document. **/
+    string_view text() const;
+    
+    /** Decode this value and everything in it into a \c value.
+     *  
+     *  \throws parse_error if any part of it can not be decoded.
+    **/
+    value materialize() const;
+    
+    /** \throws kind_error if this is not an array. **/
+    array_iterator begin_array() const;
+    array_iterator end_array() const;
+    
+    /** \throws kind_error if this is not an object. **/
+    object_iterator begin_object() const;
+    object_iterator end_object() const;
+    
+private:
+    friend class lazy_document;
+    
+    explicit lazy_value(const detail::lazy_index* index, std::uint32_t node);
+    
+    /** Find the node of the value of \a key or \c 0 if there is none (the root can never be a member). **/
+    std::uint32_t find(string_view key) const;
+    
+private:
+    const detail::lazy_index* _index;
+    std::uint32_t             _node;
+};
+
+/** Iterates over the elements of an array \c lazy_value. **/
+class JSONV_PUBLIC lazy_value::array_iterator :
+        public std::iterator<std::forward_iterator_tag, lazy_value, std::ptrdiff_t, void, lazy_value>
+{
+public:
+    lazy_value operator*() const;
+    
+    array_iterator& operator++();
+    array_iterator  operator++(int);
+    
+    bool operator==(const array_iterator& other) const { return _node == other._node; }
+    bool operator!=(const array_iterator& other) const { return _node != other._node; }
+    
+private:
+    friend class lazy_value;
+    
+    explicit array_iterator(const detail::lazy_index* index, std::uint32_t node);
+    
+private:
+    const detail::lazy_index* _index;
+    std::uint32_t             _node;
+};
+
+/** Iterates over the members of an object \c lazy_value. Each member is the decoded key and its value. **/
+class JSONV_PUBLIC lazy_value::object_iterator :
+        public std::iterator<std::forward_iterator_tag,
+                             std::pair<std::string, lazy_value>,
+                             std::ptrdiff_t,
+                             void,
+                             std::pair<std::string, lazy_value>
+                            >
+{
+public:
+    std::pair<std::string, lazy_value> operator*() const;
+    
+    object_iterator& operator++();
+    object_iterator  operator++(int);
+    
+    bool operator==(const object_iterator& other) const { return _node == other._node; }
+    bool operator!=(const object_iterator& other) const { return _node != other._node; }
+    
+private:
+    friend class lazy_value;
+    
+    explicit object_iterator(const detail::lazy_index* index, std::uint32_t node);
+    
+private:
+    const detail::lazy_index* _index;
+    std::uint32_t             _node; //!< The node of the key
+};
+
+/** A document which is parsed on demand. Constructing one builds a structural index of the input: a single pass which
+ *  finds where each value starts and ends and checks that the structure of the document is valid, but does not decode
+ *  any strings or numbers or allocate anything for them. The values are only decoded when they are accessed through
+ *  the \c root, so parts of a large document which are never looked at cost only the scan.
+ *  
+ *  The \c parse_options are applied when the index is built (structure, comments, commas, depth, leading zeros and
+ *  trailing data) or when values are decoded (\c parse_options::string_encoding). Problems with the structure are
+ *  thrown as a \c parse_error right away. Problems in the contents of strings and numbers are only found once those
+ *  are accessed. Duplicate keys are not detected.
+ *  
+ *  The input is not copied, so it must outlive the document and every \c lazy_value from it. Decoded strings and
+ *  numbers are cached in the document as they are accessed. A document can be read from many threads at once. Adding
+ *  to the cache takes a lock, but reading something which is already cached does not.
+ *  
+ *  \example "lazy_document"
+ *  \code
+ *  jsonv::mapped_file file("huge.json");
+ *  jsonv::lazy_document doc(file.contents());
+ *  std::string name = doc.root().at_path(".results[0].name").as_string();
+ *  \endcode
+**/
+class JSONV_PUBLIC lazy_document
+{
+public:
+    using size_type = std::size_t;
+    
+public:
+    /** Index the JSON \a input.
+     *  
+     *  \throws parse_error if the structure of \a input is not valid JSON.
+     *  \throws std::length_error if \a input is 4 GiB or larger.
+    **/
+    explicit lazy_document(string_view input, const parse_options& options = parse_options());
+    
+    lazy_document(lazy_document&&) noexcept;
+    lazy_document& operator=(lazy_document&&) noexcept;
+    
+    ~lazy_document() noexcept;
+    
+    /** Get the top-level value of the document. This stays valid if the document is moved. **/
+    lazy_value root() const;
+    
+    /** The number of entries in the structural index. There is one for each value and key in the document. **/
+    size_type index_size() const;
+    
+private:
+    std::unique_ptr<detail::lazy_index> _index;
+};
+
+}
+
+#endif/*__JSONV_LAZY_HPP_INCLUDED__*/
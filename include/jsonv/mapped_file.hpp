@@ -0,0 +1,83 @@
+/** \file jsonv/mapped_file.hpp
+ *  Read-only access to the contents of a file through a memory mapping.
+ *
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#ifndef __JSONV_MAPPED_FILE_HPP_INCLUDED__
+#define __JSONV_MAPPED_FILE_HPP_INCLUDED__
+
+#include <jsonv/config.hpp>
+#include <jsonv/string_view.hpp>
+
+#include <cstddef>
+#include <string>
+
+namespace jsonv
+{
+
+/** The contents of a file, mapped read-only into memory for as long as the instance lives. The system pages the file in
+ *  as it is read, so nothing is copied up front. Parse the \c contents with \c parse(const string_view&,
+ *  const parse_options&), or use \c parse_file to map, parse and unmap in one step.
+ *  
+ *  On platforms without \c mmap, the file is read into a buffer owned by the instance instead.
+ *  
+ *  \example "mapped_file"
+ *  Keep the strings of a large document in the mapping instead of copying them:
+ *  \code
+ *  jsonv::mapped_file file("export.json");
+ *  jsonv::value doc = jsonv::parse(file.contents(), jsonv::parse_options().borrow_strings(true));
+ *  // doc must not be used after file is destroyed
+ *  \endcode
+**/
+class JSONV_PUBLIC mapped_file
+{
+public:
+    using size_type = std::size_t;
+    
+public:
+    /** Map the file at \a path into memory.
+     *  
+     *  \throws std::system_error if the file can not be opened or mapped.
+    **/
+    explicit mapped_file(const std::string& path);
+    
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    
+    mapped_file(mapped_file&& source) noexcept;
+    mapped_file& operator=(mapped_file&& source) noexcept;
+    
+    /** Unmaps the file. Any \c string_view of the \c contents is left dangling. **/
+    ~mapped_file() noexcept;
+    
+    /** Get the contents of the file. **/
+    string_view contents() const
+    {
+        return string_view(_data, _size);
+    }
+    
+    /** The size of the file in bytes. **/
+    size_type size() const
+    {
+        return _size;
+    }
+    
+private:
+    void unmap() noexcept;
+    
+private:
+    const char* _data;
+    size_type   _size;
+    bool        _mapped;  //!< Does \c _data need to be unmapped (\c false if the file was empty or read into \c _copy)
+    std::string _copy;    //!< The contents of the file when it can not be mapped
+};
+
+}
+
+#endif/*__JSONV_MAPPED_FILE_HPP_INCLUDED__*/
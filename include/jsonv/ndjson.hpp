@@ -0,0 +1,122 @@
+/** \file jsonv/ndjson.hpp
+ *  Reading newline-delimited JSON (also known as JSON Lines), where each line of the input is a separate value.
+ *
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#ifndef __JSONV_NDJSON_HPP_INCLUDED__
+#define __JSONV_NDJSON_HPP_INCLUDED__
+
+#include <jsonv/config.hpp>
+#include <jsonv/parse.hpp>
+#include <jsonv/string_view.hpp>
+#include <jsonv/value.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+
+namespace jsonv
+{
+
+/** Reads newline-delimited JSON, where each line is a separate JSON value. This is the format of many logs and data
+ *  exports. Lines which are empty or only whitespace are skipped, and a \c "\r" before the \c "\n" is ignored.
+ *  
+ *  A problem in one line does not stop the reader -- it is reported with the \c record for that line, and reading goes
+ *  on with the next one. The \c parse_options::failure_mode is applied to each line on its own: with
+ *  \c parse_options::on_error::fail_immediately, a \c record with problems has a \c null result; with
+ *  \c parse_options::on_error::collect_all, it has the partial result. The positions of problems are counted from the
+ *  start of the input, like they are for \c parse. Any data after the value on a line is a problem, regardless of
+ *  \c parse_options::complete_parse.
+ *  
+ *  Unlike calling \c parse for each line, the \c tokenizer and parser state are kept from one line to the next.
+ *  
+ *  \example "ndjson_reader"
+ *  \code
+ *  std::ifstream log("events.ndjson");
+ *  jsonv::ndjson_reader reader(log);
+ *  jsonv::ndjson_reader::record rec;
+ *  while (reader.next(rec))
+ *  {
+ *      if (rec.ok())
+ *          handle(rec.result);
+ *      else
+ *          std::cerr << "Skipping line " << rec.line << ": " << rec.problems.front() << std::endl;
+ *  }
+ *  \endcode
+**/
+class JSONV_PUBLIC ndjson_reader
+{
+public:
+    using size_type = std::size_t;
+    
+    /** The result of reading one line. **/
+    struct record
+    {
+        /** The 1-based line of the input the value was on. **/
+        size_type line = 0;
+        
+        /** The value on the line. If there were \c problems, this is the partial result. **/
+        value result;
+        
+        /** The problems found on the line. This is empty if the line is valid. **/
+        parse_error::problem_list problems;
+        
+        bool ok() const
+        {
+            return problems.empty();
+        }
+    };
+    
+public:
+    /** Read lines from \a input as they are requested. The stream must outlive this instance. **/
+    explicit ndjson_reader(std::istream& input, const parse_options& options = parse_options());
+    
+    /** Read lines from the non-owned \a input. **/
+    explicit ndjson_reader(string_view input, const parse_options& options = parse_options());
+    
+    ndjson_reader(const ndjson_reader&) = delete;
+    ndjson_reader& operator=(const ndjson_reader&) = delete;
+    
+    ~ndjson_reader() noexcept;
+    
+    /** Read the next line into \a out.
+     *  
+     *  \returns \c true if a line was read; \c false if there are no more.
+    **/
+    bool next(record& out);
+    
+    /** Read all the remaining lines, calling \a on_record with the \c record of each one in the order of the input.
+     *  
+     *  If \a thread_count is more than 1, the lines are read in batches, and the lines of each batch are parsed in
+     *  parallel. \a on_record is always called on the calling thread, after the batch its line is in has been parsed.
+     *  
+     *  \param thread_count The number of threads to parse with, including the calling one. If this is 0, the number of
+     *                      hardware threads is used.
+    **/
+    void read_all(const std::function<void (record&)>& on_record, size_type thread_count = 1);
+    
+private:
+    /** Get the next line which is not blank, along with its line number and the offset of its start in the input. **/
+    bool next_line(string_view& text, size_type& line, size_type& offset);
+    
+private:
+    std::istream*                          _stream;
+    string_view                            _input;    //!< The input when not reading from \c _stream
+    size_type                              _position; //!< The offset of the next line in the input
+    size_type                              _line;     //!< The number of lines which have been read
+    std::string                            _buffer;   //!< The last line read from \c _stream
+    parse_options                          _options;
+    std::unique_ptr<detail::record_parser> _parser;
+};
+
+}
+
+#endif/*__JSONV_NDJSON_HPP_INCLUDED__*/
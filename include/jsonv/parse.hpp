@@ -16,7 +16,9 @@
 #include <jsonv/value.hpp>
 
 #include <cstddef>
+#include <cstdint>
 #include <deque>
+#include <memory>
 #include <stdexcept>
 
 namespace jsonv
@@ -24,6 +26,13 @@ namespace jsonv
 
 class tokenizer;
 
+namespace detail
+{
+
+class record_parser;
+
+}
+
 /** An error encountered when parsing.
  *  
  *  \see parse
@@ -231,6 +240,10 @@ public:
     /** The maximum allowed nesting depth of any structure in the JSON document. The JSON specification technically
      *  limits the depth to 20, but very few implementations actually conform to this, so it is fairly dangerous to set
      *  this value. By default, the value is 0, which means we should not do any depth checking.
+     *  
+     *  The depth is checked as the input is parsed, so an overly-deep document is rejected as soon as the limit is
+     *  reached. If the \c failure_mode allows parsing to continue, the contents of the offending structure are skipped
+     *  and it appears as an empty array or object in the result.
     **/
     size_type max_structure_depth() const;
     parse_options& max_structure_depth(size_type depth);
@@ -261,6 +274,17 @@ public:
     bool comments() const;
     parse_options& comments(bool);
     
+    /** Should string values without escape sequences refer to the input instead of being copied out of it (see
+     *  \c borrowed_string)? This is off by default. When it is on, the input must outlive the parsed result. It is
+     *  meant for input which stays in memory anyway, such as a \c mapped_file. Object keys are always copied.
+     *  
+     *  This only applies when parsing from a \c string_view or from a \c tokenizer constructed from one (see
+     *  \c tokenizer::input_is_stable). It is ignored when the tokens come from an \c std::istream, by \c parse_file,
+     *  which does not keep its input, and by an \c ndjson_reader reading from an \c std::istream.
+    **/
+    bool borrow_strings() const;
+    parse_options& borrow_strings(bool);
+    
 private:
     // For the purposes of ABI compliance, most modifications to the variables in this class should bump the minor
     // version number.
@@ -273,6 +297,57 @@ private:
     bool        _require_document = false;
     bool        _complete_parse   = true;
     bool        _comments         = true;
+    bool        _borrow_strings   = false;
+};
+
+/** Receives the contents of a document from \c parse(tokenizer&, parse_handler&, const parse_options&) as a sequence of
+ *  events, without a \c value tree ever being built. This is useful for scanning or filtering documents which are too
+ *  large to hold in memory or when only a small part of them is needed. Every function does nothing by default, so
+ *  implementations only need to override the events they care about.
+ *  
+ *  Arrays and objects are delivered as a begin event, their contents and an end event. Each value in an object is
+ *  preceded by a call to \c on_key. Strings and keys are decoded before they are delivered; the \c string_view is only
+ *  valid until the handler returns, so copy it if it needs to be kept.
+ *  
+ *  \example "parse_handler"
+ *  Count the number of objects in a document.
+ *  \code
+ *  struct object_counter : jsonv::parse_handler
+ *  {
+ *      std::size_t count = 0;
+ *      
+ *      void on_object_begin() override { ++count; }
+ *  };
+ *  
+ *  object_counter counter;
+ *  jsonv::parse(input, counter);
+ *  \endcode
+**/
+class JSONV_PUBLIC parse_handler
+{
+public:
+    virtual ~parse_handler() noexcept;
+    
+    virtual void on_null();
+    
+    virtual void on_boolean(bool value);
+    
+    virtual void on_integer(std::int64_t value);
+    
+    virtual void on_decimal(double value);
+    
+    virtual void on_string(string_view value);
+    
+    virtual void on_array_begin();
+    
+    virtual void on_array_end();
+    
+    virtual void on_object_begin();
+    
+    /** Called with the key of the next value in the object being parsed. **/
+    virtual void on_key(string_view key);
+    
+    virtual void on_object_end();
 };
 
 /** Reads a JSON value from the input stream.
@@ -307,8 +382,39 @@ value JSONV_PUBLIC parse(const string_view& input, const parse_options& = parse_
 **/
 value JSONV_PUBLIC parse(const char* begin, const char* end, const parse_options& = parse_options());
 
+/** Reads a JSON value from the file at \a path. The file is memory-mapped (see \c mapped_file), so it is tokenized in
+ *  place instead of being copied into a buffer first, and the system only reads the pages of it the parser gets to. The
+ *  file is unmapped before this returns, so \c parse_options::borrow_strings is ignored. To keep strings which refer to
+ *  the file, construct a \c mapped_file and parse its \c mapped_file::contents.
+ *  
+ *  \throws std::system_error if the file can not be opened or mapped.
+ *  \throws parse_error if an error is found in the JSON.
+**/
+value JSONV_PUBLIC parse_file(const std::string& path, const parse_options& = parse_options());
+
+/** Construct a JSON value from \a input, parsing the elements of a top-level array on \a thread_count threads. This is
+ *  meant for large inputs which are an array of many records. A quick pass over the top level of the array finds where
+ *  each element begins and ends (without looking inside of them, like \c tokenizer::skip_structure), then the elements
+ *  are parsed in parallel and put into the result in their original order. For anything else -- an input which is not
+ *  an array or which has problems in the top-level array itself -- this is the same as \c parse.
+ *  
+ *  The result is the same as \c parse would give. If any element has a problem, the other threads stop and the whole
+ *  input is given to \c parse, so the problems reported and the partial result are exactly those of \c parse for every
+ *  \c parse_options::on_error mode. Invalid input costs a second parse, while valid input never does.
+ *  
+ *  \param thread_count The number of threads to parse with, including the calling one. If this is 0, the number of
+ *                      hardware threads is used.
+ *  
+ *  \throws parse_error if an error is found in the JSON.
+**/
+value JSONV_PUBLIC parse_parallel(const string_view&   input,
+                                  const parse_options& options      = parse_options(),
+                                  std::size_t          thread_count = 0
+                                 );
+
 /** Reads a JSON value from a buffered \c tokenizer. This less convenient function is useful when setting
- *  \c parse_options::complete_parse to \c false.
+ *  \c parse_options::complete_parse to \c false. The positions of problems are counted from the start of the input the
+ *  \c tokenizer was constructed with, not from where this call started reading.
  *  
  *  \see parse(std::istream&, const parse_options&)
  *  
@@ -323,6 +429,94 @@ value JSONV_PUBLIC parse(const char* begin, const char* end, const parse_options
 **/
 value JSONV_PUBLIC parse(tokenizer& input, const parse_options& = parse_options());
 
+/** Construct a JSON value from the given \a input, allocating the nodes of the resulting tree from \a region.
+ *  Destroying the result does not give the nodes back to the heap; their memory is returned when \a region is
+ *  released. The result must not outlive \a region -- copy it if it needs to (see \c arena for details). If a
+ *  \c parse_error is thrown, its \c parse_error::partial_result is a copy on the heap, so it is safe to use after
+ *  \a region is gone.
+ *  
+ *  \example "parse(const string_view&, arena&, const parse_options&)"
+ *  \code
+ *  jsonv::arena region;
+ *  jsonv::value doc = jsonv::parse(input, region);
+ *  process(doc);
+ *  \endcode
+ *  
+ *  \throws parse_error if an error is found in the JSON.
+**/
+value JSONV_PUBLIC parse(const string_view& input, arena& region, const parse_options& = parse_options());
+
+/** Reads a JSON value from a buffered \c tokenizer, allocating the resulting tree from \a region.
+ *  
+ *  \see parse(const string_view&, arena&, const parse_options&)
+**/
+value JSONV_PUBLIC parse(tokenizer& input, arena& region, const parse_options& = parse_options());
+
+/** Reads a JSON value from a buffered \c tokenizer, sending its contents to \a handler instead of building a \c value.
+ *  This applies the same \c parse_options and reports the same problems as the other \c parse functions (the DOM parse
+ *  is built on the same events), except that duplicate keys in an object are not tracked -- they are passed along to
+ *  \a handler like any other key. A document which is invalid in the middle will have had the events before the problem
+ *  delivered to \a handler and, if the \c parse_options::failure_mode keeps going, some events after it. Structures
+ *  which are never closed because the input ends early do not get an end event.
+ *  
+ *  \throws parse_error if an error is found in the JSON. The \c parse_error::partial_result is always \c null.
+**/
+void JSONV_PUBLIC parse(tokenizer& input, parse_handler& handler, const parse_options& = parse_options());
+
+/** Reads a JSON value from \a input, sending its contents to \a handler.
+ *  
+ *  \see parse(tokenizer&, parse_handler&, const parse_options&)
+**/
+void JSONV_PUBLIC parse(const string_view& input, parse_handler& handler, const parse_options& = parse_options());
+
+/** Parses many inputs with the same \c parse_options, keeping everything it can from one input to the next: its copy of
+ *  the options, the string decoder they select, the \c tokenizer and the working storage of the parser. When parsing
+ *  lots of small inputs, like the bodies of requests to a server, this takes nearly all of the setup out of each call.
+ *  The results are the same as from \c parse with the same options.
+ *  
+ *  A \c parser is not thread-safe. Use a separate one on each thread.
+ *  
+ *  \example "parser"
+ *  \code
+ *  jsonv::parser request_parser(jsonv::parse_options::create_strict());
+ *  for (const std::string& body : bodies)
+ *      handle(request_parser.parse(body));
+ *  \endcode
+**/
+class JSONV_PUBLIC parser
+{
+public:
+    explicit parser(const parse_options& options = parse_options());
+    
+    parser(const parser&) = delete;
+    parser& operator=(const parser&) = delete;
+    
+    parser(parser&&) noexcept;
+    parser& operator=(parser&&) noexcept;
+    
+    ~parser() noexcept;
+    
+    const parse_options& options() const;
+    
+    /** Construct a JSON value from the given \a input.
+     *  
+     *  \see parse(const string_view&, const parse_options&)
+     *  \throws parse_error if an error is found in the JSON.
+    **/
+    value parse(const string_view& input);
+    
+    /** Construct a JSON value from the given \a input, allocating the resulting tree from \a region.
+     *  
+     *  \see parse(const string_view&, arena&, const parse_options&)
+     *  \throws parse_error if an error is found in the JSON.
+    **/
+    value parse(const string_view& input, arena& region);
+    
+private:
+    std::unique_ptr<detail::record_parser> _impl;
+    parse_error::problem_list              _problems;
+};
+
 }
 
 #endif/*__JSONV_PARSE_HPP_INCLUDED__*/
@@ -0,0 +1,191 @@
+/** \file jsonv/reader.hpp
+ *  A pull-style reader for walking through JSON without building a \c value for all of it.
+ *
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#ifndef __JSONV_READER_HPP_INCLUDED__
+#define __JSONV_READER_HPP_INCLUDED__
+
+#include <jsonv/config.hpp>
+#include <jsonv/parse.hpp>
+#include <jsonv/string_view.hpp>
+#include <jsonv/value.hpp>
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace jsonv
+{
+
+/** Reads JSON one event at a time, at the pace of the caller. Where \c parse_handler has every event of a document
+ *  pushed at it, a \c reader lets the caller pull the events it wants with \c next_event and pass over the ones it does
+ *  not with \c skip_value. Skipping an array or object only looks for its closing bracket (see
+ *  \c tokenizer::skip_structure) -- nothing inside of it is decoded -- so pulling a few fields out of a large document
+ *  costs little more than reading through it. The parts which are wanted can be turned into a \c value with
+ *  \c read_value.
+ *  
+ *  The \c parse_options are applied as they are by \c parse, with two exceptions. The first problem is always thrown as
+ *  a \c parse_error, since there is no way to keep reading past it. \c parse_options::duplicate_key_action only applies
+ *  inside of values built by \c read_value; the keys of an object walked with \c next_event are not remembered, so
+ *  duplicates among them are not detected. What is skipped is not checked at all.
+ *  
+ *  \example "reader"
+ *  Get the \c "id" of each record in a large array, without looking at the rest of the record.
+ *  \code
+ *  jsonv::reader in(input);
+ *  in.next_event(); // array_begin
+ *  while (in.next_event() == jsonv::reader::event::object_begin)
+ *  {
+ *      while (in.next_event() == jsonv::reader::event::key)
+ *      {
+ *          if (in.as_string() == "id")
+ *              ids.push_back(in.read_value());
+ *          else
+ *              in.skip_value();
+ *      }
+ *  }
+ *  \endcode
+**/
+class JSONV_PUBLIC reader
+{
+public:
+    using size_type = std::size_t;
+    
+    enum class event : unsigned char
+    {
+        null,
+        boolean,
+        integer,
+        decimal,
+        string,
+        array_begin,
+        array_end,
+        object_begin,
+        /** The key of the next value in an object. The key itself is available from \c as_string. **/
+        key,
+        object_end,
+        /** The document has been read completely. **/
+        end,
+    };
+    
+public:
+    /** Create a reader which gets tokens from \a input. The \a input must outlive this instance. **/
+    explicit reader(tokenizer& input, const parse_options& options = parse_options());
+    
+    /** Create a reader of the non-owned \a input. **/
+    explicit reader(string_view input, const parse_options& options = parse_options());
+    
+    reader(const reader&) = delete;
+    reader& operator=(const reader&) = delete;
+    
+    ~reader() noexcept;
+    
+    /** Move to the next event in the document. Once the document is finished, this returns \c event::end.
+     *  
+     *  \throws parse_error if the input is not valid JSON.
+    **/
+    event next_event();
+    
+    /** Get the event the last call to \c next_event returned. **/
+    event current_event() const;
+    
+    /** Get the number of arrays and objects which are currently open. **/
+    size_type depth() const;
+    
+    /** \throws std::logic_error if the \c current_event is not \c event::boolean. **/
+    bool as_boolean() const;
+    
+    /** \throws std::logic_error if the \c current_event is not \c event::integer. **/
+    std::int64_t as_integer() const;
+    
+    /** Get the current number as a \c double. This works for \c event::integer as well as \c event::decimal.
+     *  
+     *  \throws std::logic_error if the \c current_event is not a number.
+    **/
+    double as_decimal() const;
+    
+    /** Get the decoded contents of the current string or key. This is only valid until the next call which moves this
+     *  reader, so copy it if it needs to be kept.
+     *  
+     *  \throws std::logic_error if the \c current_event is not \c event::string or \c event::key.
+    **/
+    string_view as_string() const;
+    
+    /** Skip over a value. After \c event::array_begin or \c event::object_begin, this skips the rest of the array or
+     *  object without decoding any of it, so the \c current_event becomes the matching \c event::array_end or
+     *  \c event::object_end. After \c event::key, this skips the value for that key; if it is not an array or object,
+     *  it is a single token which is read as \c next_event would. After any other value, this does nothing.
+     *  
+     *  \throws parse_error if the input ends before the skipped value does.
+     *  \throws std::logic_error if the \c current_event does not start a value.
+    **/
+    void skip_value();
+    
+    /** Read a whole value into a \c value. This works on the same value as \c skip_value would skip and leaves this
+     *  reader in the same place.
+     *  
+     *  \throws parse_error if the value is not valid JSON.
+     *  \throws std::logic_error if the \c current_event does not start a value.
+    **/
+    value read_value();
+    
+private:
+    struct frame
+    {
+        bool object;
+        bool need_separator; //!< Has a value been finished since the last ','?
+        bool after_comma;
+    };
+    
+private:
+    bool next_token();
+    
+    /** Get the event for the value which starts at the current token. **/
+    event start_value();
+    
+    /** Move past the ':' after a key and to the first token of its value. **/
+    void start_keyed_value();
+    
+    /** Record that a value has been finished in the current structure. **/
+    void finish_value();
+    
+    event finish_document();
+    
+    void expect_event(event expected, const char* function) const;
+    
+    template <typename... T>
+    [[noreturn]]
+    void parse_error(T&&... message) const;
+    
+private:
+    std::unique_ptr<tokenizer> _owned_input;
+    tokenizer&                 _input;
+    parse_options              _options;
+    event                      _event;
+    std::vector<frame>         _frames;
+    bool                       _after_key;     //!< Was the last event a key whose value has not been started?
+    bool                       _root_finished; //!< Has the root value been finished?
+    bool                       _input_ended;   //!< Has \c next_token run out of input?
+    
+    bool                       _boolean;
+    std::int64_t               _integer;
+    double                     _decimal;
+    string_view                _string;        //!< Refers to the input or to \c _decoded
+    std::string                _decoded;
+};
+
+/** Get a string representation of a \c reader::event. **/
+JSONV_PUBLIC std::ostream& operator<<(std::ostream&, const reader::event&);
+
+}
+
+#endif/*__JSONV_READER_HPP_INCLUDED__*/
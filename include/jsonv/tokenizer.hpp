@@ -85,6 +85,10 @@ JSONV_PUBLIC std::ostream& operator<<(std::ostream&, const token_kind&);
 JSONV_PUBLIC std::string to_string(const token_kind&);
 
 /** Splits input into tokens, allowing traversal of JSON without verification. This is the basis for JSON parsers.
+ *  
+ *  When constructed from an \c std::istream, the input is read in chunks as tokens are requested instead of all at once.
+ *  Only the current token and the data after it are kept in memory, so the memory used is proportional to the largest
+ *  token, not to the size of the input.
  *  
  *  An important thing to remember is a \c tokenizer does not perform any real validation of any kind beyond emitting
  *  a \c token_kind::unknown when it encounters complete garbage. What does this mean? Given the input string:
@@ -101,12 +105,12 @@ class JSONV_PUBLIC tokenizer
 public:
     using size_type = std::vector<char>::size_type;
     
-    /// \deprecated
-    /// See \ref buffer_reserve.
+    /** The number of characters a \c tokenizer reading from an \c std::istream starts with room for. This is the size
+     *  of each read from the stream unless a token is larger than it.
+    **/
     static size_type min_buffer_size();
     
-    /// \deprecated
-    /// See \ref buffer_reserve.
+    /** Set the \c min_buffer_size for all \c tokenizer instances constructed after this call. **/
     static void set_min_buffer_size(size_type sz);
     
     /** A representation of what this tokenizer has. **/
@@ -114,6 +118,11 @@ public:
     {
         string_view text;
         token_kind kind;
+        /** If \c kind is \c token_kind::string, is the content between the quotes exactly what decoding it would
+         *  produce? This is \c true when the string contains no escape sequences, control characters or non-ASCII
+         *  characters, in which case it can be copied without decoding.
+        **/
+        bool verbatim;
         
         operator std::pair<string_view, token_kind>()
         {
@@ -125,14 +134,33 @@ public:
     /// Construct a tokenizer to read the given non-owned \a input.
     explicit tokenizer(string_view input);
 
-    /// Construct a tokenizer from the provided \a input.
+    /** Construct a tokenizer which reads from the provided \a input as tokens are requested. The stream must outlive
+     *  this instance.
+    **/
     explicit tokenizer(std::istream& input);
     
+    tokenizer(const tokenizer&) = delete;
+    tokenizer& operator=(const tokenizer&) = delete;
+    
     ~tokenizer() noexcept;
     
-    /// Get the input this instance is reading from.
+    /** Start reading the non-owned \a input from the beginning, as if this instance had just been constructed with it.
+     *  This keeps the memory already allocated, which makes it cheaper than constructing a new \c tokenizer for each of
+     *  many small inputs.
+    **/
+    void reset(string_view input);
+    
+    /** Get the input this instance is reading from. When reading from an \c std::istream, this is only the portion of
+     *  the stream which is currently buffered, which starts at or before the text of \c current.
+    **/
     const string_view& input() const;
     
+    /** Does the text of tokens stay valid for as long as the input does? This is \c true when reading from a
+     *  \c string_view. When reading from an \c std::istream, the buffered text is dropped or moved as more of the
+     *  stream is read, so the text of a token is only valid until \c next is called.
+    **/
+    bool input_is_stable() const;
+    
     /** Attempt to go to the next token in the input stream. The contents of \c current will be cleared.
      * 
      *  \returns \c true if another token was obtained; \c false if we reached EOF or an I/O failure. Check \c input to
@@ -147,18 +175,55 @@ public:
     **/
     const token& current() const;
     
-    /// \deprecated
-    /// Calling this function has no effect and will be removed in 2.0.
+    /** Skip to the end of the array or object the current token opens. Only brackets, strings and comments are looked
+     *  at to find the end, so this is much faster than calling \c next until the end, but it does nothing to check that
+     *  what it skips is valid JSON. When this returns \c true, \c current is the closing \c token_kind::array_end or
+     *  \c token_kind::object_end. When reading from an \c std::istream, the skipped text is not kept in memory.
+     *  
+     *  \returns \c true if the end of the structure was found; \c false if the input ended first, in which case there
+     *           is no \c current token.
+     *  \throws std::logic_error if the \c current token is not a \c token_kind::array_begin or
+     *                           \c token_kind::object_begin.
+    **/
+    bool skip_structure();
+    
+    /** Make sure a \c tokenizer reading from an \c std::istream has room to buffer at least \a sz characters, so reads
+     *  from the stream are at least that large. This has no effect on a \c tokenizer reading from a \c string_view.
+    **/
     void buffer_reserve(size_type sz);
     
+    /** Find where \a position is in the input, counting from the start of the input this \c tokenizer was constructed
+     *  with. Line numbers are only needed to report problems, so they are not tracked while tokenizing. Instead, line
+     *  breaks are counted the first time a position past them is located.
+     *  
+     *  \param position A pointer into \c input, at or after the start of the text of \c current.
+     *  \param[out] line The 1-based line \a position is on.
+     *  \param[out] column The 1-based column \a position is at.
+     *  \param[out] character The 0-based offset of \a position from the start of the input.
+    **/
+    void locate(const char* position, size_type& line, size_type& column, size_type& character);
+    
 private:
-    explicit tokenizer(std::shared_ptr<std::string> input);
+    /** Drop the buffered data before the \c current token and read more from \c _stream after what is left.
+     *  
+     *  \returns \c true if more data was read; \c false if the stream is exhausted or this is not reading from a stream.
+    **/
+    bool refill();
+    
+    /** Record the line breaks in the input up to the \a offset from the start of the input. **/
+    void scan_newlines(size_type offset);
     
 private:
-    string_view           _input;
-    const char*           _position;
-    token                 _current;  //!< The current token
-    std::shared_ptr<void> _track;    //!< Used to track input data when needed (\c std::istream constructor)
+    string_view            _input;             //!< The part of the input in memory
+    const char*            _position;
+    token                  _current;           //!< The current token
+    std::istream*          _stream;            //!< The stream to refill from (\c std::istream constructor)
+    std::vector<char>      _buffer;            //!< The storage \c _input refers to when reading from \c _stream
+    size_type              _discarded;         //!< The number of characters dropped from before \c _input
+    std::vector<size_type> _newlines;          //!< Offsets of line breaks in `[_discarded, _newlines_scanned)`
+    size_type              _newlines_scanned;  //!< How far \c _newlines has been built
+    size_type              _newlines_dropped;  //!< The number of line breaks before \c _discarded
+    size_type              _last_dropped_line; //!< The offset of the last line break before \c _discarded
 };
 
 }
@@ -11,9 +11,11 @@
 #ifndef __JSONV_VALUE_HPP_INCLUDED__
 #define __JSONV_VALUE_HPP_INCLUDED__
 
+#include <jsonv/arena.hpp>
 #include <jsonv/config.hpp>
 #include <jsonv/string_view.hpp>
 #include <jsonv/detail/basic_view.hpp>
+#include <jsonv/detail/flat_map.hpp>
 
 #include <cstddef>
 #include <cstdint>
@@ -41,6 +43,24 @@ class object_impl;
 class array_impl;
 class string_impl;
 
+/** The container backing a \c value with \c kind::object.
+ *  
+ *  \see JSONV_OBJECT_USE_FLAT_MAP
+**/
+#if JSONV_OBJECT_USE_FLAT_MAP
+using object_map = flat_map<std::string,
+                            value,
+                            std::less<std::string>,
+                            arena_allocator<std::pair<const std::string, value>>
+                           >;
+#else
+using object_map = std::map<std::string,
+                            value,
+                            std::less<std::string>,
+                            arena_allocator<std::pair<const std::string, value>>
+                           >;
+#endif
+
 union value_storage
 {
     object_impl* object;
@@ -77,6 +97,54 @@ enum class kind : unsigned char
     boolean
 };
 
+namespace detail
+{
+
+/** The fields of a \c value with any content other than a short string. **/
+struct value_fields
+{
+    jsonv::kind   kind;
+    unsigned char short_tag;
+    value_storage data;
+    
+    constexpr explicit value_fields(jsonv::kind k) :
+            kind(k),
+            short_tag(0),
+            data()
+    { }
+};
+
+/** The fields of a \c value holding a string of up to \c capacity characters. Instead of allocating a \c string_impl,
+ *  the characters are stored in the space \c value_fields uses for \c value_storage and padding.
+ *  
+ *  The \c kind and \c short_tag are the common initial sequence with \c value_fields, so they can be read no matter
+ *  which of the two is in use. The \c short_tag is 0 for \c value_fields and one more than the length of the string
+ *  for \c short_string_fields.
+**/
+struct short_string_fields
+{
+    static constexpr std::size_t capacity = 14;
+    
+    jsonv::kind   kind;
+    unsigned char short_tag;
+    char          data[capacity];
+};
+
+/** The fields of a \c value referring to the characters of a string it does not own (see \c borrowed_string). The
+ *  \c short_tag is always \c tag, which is larger than any length a \c short_string_fields can have.
+**/
+struct borrowed_string_fields
+{
+    static constexpr unsigned char tag = 0xff;
+    
+    jsonv::kind   kind;
+    unsigned char short_tag;
+    std::uint32_t length;
+    const char*   data;
+};
+
+}
+
 /** Print out the name of the \c kind. **/
 JSONV_PUBLIC std::ostream& operator<<(std::ostream&, const kind&);
 
@@ -117,13 +185,14 @@ public:
  *     the cases where it makes sense (for example: \c empty and \c size), but in general, string manipulation should be
  *     done after calling \c as_string.
  *   - \c kind::array
- *     An array behaves like a \c std::deque because it is ultimately backed by one. If you feel the documentation is
- *     lacking, read this: http://en.cppreference.com/w/cpp/container/deque.
+ *     An array behaves like a \c std::vector because it is ultimately backed by one. If you feel the documentation is
+ *     lacking, read this: http://en.cppreference.com/w/cpp/container/vector.
  *   - \c kind::object
  *     An object behaves lake a \c std::map because it is ultimately backed by one. If you feel the documentation is
  *     lacking, read this: http://en.cppreference.com/w/cpp/container/map. This library follows the recommendation in
  *     RFC 7159 to not allow for duplicate keys because most other libraries can not deal with it. It would also make
- *     the AST significantly more painful.
+ *     the AST significantly more painful. If the library is built with \c JSONV_OBJECT_USE_FLAT_MAP, the members are
+ *     kept in a sorted vector instead, which still has the \c std::map interface, but not its iterator stability.
  *  
  *  \see http://json.org/
  *  \see http://tools.ietf.org/html/rfc7159
@@ -403,8 +472,8 @@ public:
     /** The \c object_iterator is applicable when \c kind is \c kind::object. It allows you to use algorithms as if
      *  a \c value was a normal associative container.
     **/
-    typedef basic_object_iterator<object_value_type,       std::map<std::string, value>::iterator>       object_iterator;
-    typedef basic_object_iterator<const object_value_type, std::map<std::string, value>::const_iterator> const_object_iterator;
+    typedef basic_object_iterator<object_value_type,       detail::object_map::iterator>       object_iterator;
+    typedef basic_object_iterator<const object_value_type, detail::object_map::const_iterator> const_object_iterator;
     
     /** If \c kind is \c kind::object, an \c object_view allows you to access a value as an associative container.
      *  This is most useful for range-based for loops.
@@ -430,18 +499,23 @@ public:
 public:
     /** Default-construct this to null. **/
     constexpr value() :
-            _kind(jsonv::kind::null)
+            _fields(jsonv::kind::null)
     { }
     
     /** The nullptr overload will fail to compile -- use \c null if you want a \c kind::null. **/
     value(std::nullptr_t) = delete;
     
-    /** Copy the contents of \a source into a new instance. **/
+    /** Copy the contents of \a source into a new instance. Parts of \a source which have had sharing enabled are not
+     *  copied, but shared with the new instance (see \c enable_sharing).
+    **/
     value(const value& source);
     
     /** Create a \c kind::string with the given \a value. **/
     value(const std::string& value);
 
+    /** Create a \c kind::string with the given \a value. **/
+    value(std::string&& value);
+
     /** Create a \c kind::string with the given \a value. **/
     value(const string_view& value);
     
@@ -450,6 +524,12 @@ public:
      *  \param value The value to create with. This must be null-terminated.
     **/
     value(const char* value);
+
+    /** Create a \c kind::string with the given \a value, allocating the node from \a region.
+     *  
+     *  \see arena
+    **/
+    value(arena& region, const string_view& value);
     
     /// Create a \c kind::string with the given \a value. Keep in mind that it will be converted to and stored as a
     /// UTF-8 encoded string.
@@ -496,16 +576,25 @@ public:
     **/
     value& operator=(value&& source) noexcept;
     
-    /** Get this value as a string.
+    /** Get a copy of this value as a string.
+     *  
+     *  \note
+     *  Before 1.5, this returned a <tt>const std::string&</tt>. Strings short enough to be stored inside of the
+     *  \c value and strings made by \c borrowed_string do not have a \c std::string to refer to, so this now always
+     *  returns a copy, which costs an allocation for anything too long for the small string optimization of
+     *  \c std::string. Code which kept a reference or pointer to the result must keep a copy instead. Use
+     *  \c as_string_view to look at the contents without copying them.
      *  
      *  \throws kind_error if this value does not represent a string.
     **/
-    const std::string& as_string() const;
+    std::string as_string() const;
     
     /** Tests if this \c kind is \c kind::string. **/
     bool is_string() const;
 
     /** Get this value as a \c string_view. It is your responsibility to ensure the \c value instance remains valid.
+     *  Strings of up to \c detail::short_string_fields::capacity characters are stored inside of the \c value itself,
+     *  so the view is also invalidated by moving the \c value (such as an array growing).
      *
      *  \throws kind_error if this value does not represent a string.
     **/
@@ -558,10 +647,29 @@ public:
     /** Resets this value to null. **/
     void clear();
     
+    /** Enable structural sharing for this value and everything in it. Once enabled, copying this value (or any value
+     *  inside of it) takes constant time and memory: the copy refers to the same contents and only makes its own copy
+     *  of an object, array or string the first time either of them is modified (copy-on-write). Copying a value which
+     *  was modified this way keeps sharing its unmodified children, so a document can be shared between many readers,
+     *  including across threads, at the cost of a single tree.
+     *  
+     *  Sharing stays enabled for copies, but values added to a tree after this call are not shared until this is called
+     *  again. Parts of the tree allocated from an \c arena are never shared, since copies are used to let values
+     *  escape the lifetime of their \c arena.
+     *  
+     *  Handing out a mutable reference or iterator into an object or array (through \c operator[], \c at, \c find,
+     *  \c begin_object and the like on a non-const value) makes that object or array its own again and keeps later
+     *  copies from sharing it, so references and iterators always refer to the value they were taken from, even after
+     *  it is copied. Copies of such a value still share the children which were not accessed this way. Calling this
+     *  again shares everything again, so references taken before that must not be written through afterwards. Reading
+     *  through a const value never copies anything.
+    **/
+    void enable_sharing();
+    
     /** Get this value's kind. **/
     inline jsonv::kind kind() const
     {
-        return _kind;
+        return _fields.kind;
     }
     
     /** Get the value specified by the path \a p.
@@ -699,7 +807,13 @@ public:
     value& at(size_type idx);
     const value& at(size_type idx) const;
     
-    /** Push \a item to the back of this array.
+    /** Push \a item to the back of this array. If the new size is larger than the capacity, the storage is reallocated
+     *  and all iterators and references to elements of this array are invalidated. Otherwise, only the end iterator
+     *  is invalidated.
+     *  
+     *  \note
+     *  Before 1.5, arrays were stored in a \c std::deque and \c push_back never invalidated references. Call
+     *  \c reserve first if references need to stay valid while items are added.
      *  
      *  \throws kind_error if the kind is not an array.
     **/
@@ -712,20 +826,21 @@ public:
     **/
     void pop_back();
     
-    /** Push \a item to the front of this array.
+    /** Push \a item to the front of this array. This moves every other item in the array.
      *  
      *  \throws kind_error if the kind is not an array.
     **/
     void push_front(value item);
     
-    /** Pop an item from the front of this array.
+    /** Pop an item from the front of this array. This moves every other item in the array.
      *  
      *  \throws kind_error if the kind is not an array.
      *  \throws std::logic_error if the array is empty.
     **/
     void pop_front();
     
-    /** Insert an item into \a position on this array.
+    /** Insert an item into \a position on this array. If the storage is reallocated, all iterators and references to
+     *  elements of this array are invalidated. Otherwise, only those at or after \a position are.
      *  
      *  \throws kind_error if the kind is not an array.
     **/
@@ -781,6 +896,14 @@ public:
     **/
     void resize(size_type count, const value& val = value());
     
+    /** Reserve storage for at least \a count items in this array, so it can grow to that size without reallocating.
+     *  If \a count is larger than the current capacity, all iterators and references to elements of this array are
+     *  invalidated.
+     *  
+     *  \throws kind_error if the kind is not an array.
+    **/
+    void reserve(size_type count);
+    
     /** Erase the item at this array's \a position.
      * 
      *  \throws kind_error if the kind is not an array.
@@ -985,11 +1108,35 @@ public:
     
 private:
     friend JSONV_PUBLIC value array();
+    friend JSONV_PUBLIC value array(arena&);
     friend JSONV_PUBLIC value object();
+    friend JSONV_PUBLIC value object(arena&);
+    friend JSONV_PUBLIC value borrowed_string(string_view);
     
 private:
-    detail::value_storage _data;
-    jsonv::kind           _kind;
+    /** Is this a string without a \c string_impl, stored in either \c _short or \c _borrowed? These can be copied
+     *  and destroyed without regard to ownership.
+    **/
+    bool is_unowned_string() const
+    {
+        return _fields.short_tag != 0;
+    }
+    
+    /** Set this null value to a string with the contents of \a source, allocating a \c string_impl from \a region if
+     *  it is too long to be stored inline.
+    **/
+    void init_string(string_view source, arena* region);
+    
+    /** Copy the fields of \a source into this value as-is, without regard to ownership. **/
+    void copy_fields(const value& source) noexcept;
+    
+private:
+    union
+    {
+        detail::value_fields           _fields;
+        detail::short_string_fields    _short;
+        detail::borrowed_string_fields _borrowed;
+    };
 };
 
 /** An instance with \c kind::null. This is intended to be used for convenience and readability (as opposed to using the
@@ -1015,6 +1162,12 @@ JSONV_PUBLIC void swap(value& a, value& b) noexcept;
 /** Create an empty array value. **/
 JSONV_PUBLIC value array();
 
+/** Create an empty array whose storage is allocated from \a region.
+ *  
+ *  \see arena
+**/
+JSONV_PUBLIC value array(arena& region);
+
 /** Create an array value from the given source. **/
 JSONV_PUBLIC value array(std::initializer_list<value> source);
 
@@ -1030,6 +1183,12 @@ value array(TForwardIterator first, TForwardIterator last)
 /** Create an empty object. **/
 JSONV_PUBLIC value object();
 
+/** Create an empty object whose storage is allocated from \a region.
+ *  
+ *  \see arena
+**/
+JSONV_PUBLIC value object(arena& region);
+
 /** Create an object with key-value pairs from the given \a source. **/
 JSONV_PUBLIC value object(std::initializer_list<std::pair<std::string, value>>  source);
 JSONV_PUBLIC value object(std::initializer_list<std::pair<std::wstring, value>> source);
@@ -1043,6 +1202,13 @@ value object(TForwardIterator first, TForwardIterator last)
     return obj;
 }
 
+/** Create a string value which refers to the characters of \a source instead of copying them. Nothing is allocated, but
+ *  the memory behind \a source must outlive the result and every copy of it (copies refer to the same characters). This
+ *  is what \c parse_options::borrow_strings uses to avoid copying strings out of a \c mapped_file. Strings short enough
+ *  to be stored inside of the \c value and strings longer than \c std::uint32_t can count are copied instead.
+**/
+JSONV_PUBLIC value borrowed_string(string_view source);
+
 /// A <a href="http://en.cppreference.com/w/cpp/container/node_handle">node handle</a> used when a value is
 /// \ref kind::object to access elements of the object in potentially destructive manner. This makes it possible to
 /// modify the contents of a node extracted from an object, and then re-insert it without having to copy the element.
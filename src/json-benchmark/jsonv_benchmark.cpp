@@ -11,6 +11,8 @@
 #include "core.hpp"
 
 #include <jsonv/all.hpp>
+#include <jsonv/detail/char_scan.hpp>
+#include <jsonv/detail/scope_exit.hpp>
 
 namespace json_benchmark
 {
@@ -31,4 +33,24 @@ protected:
     
 } jsonv_benchmark_suite_instance;
 
+/** Same as the "JSONV" suite, but with vectorized character scanning disabled. **/
+class jsonv_scalar_benchmark_suite :
+        public typed_benchmark_suite<jsonv::value>
+{
+public:
+    jsonv_scalar_benchmark_suite() :
+            typed_benchmark_suite<jsonv::value>("JSONV-scalar")
+    { }
+    
+protected:
+    virtual jsonv::value parse(const std::string& source) const
+    {
+        auto old_isa = jsonv::detail::active_scan_isa();
+        auto restore = jsonv::detail::on_scope_exit([old_isa] { jsonv::detail::set_scan_isa(old_isa); });
+        jsonv::detail::set_scan_isa(jsonv::detail::scan_isa::scalar);
+        return jsonv::parse(source);
+    }
+    
+} jsonv_scalar_benchmark_suite_instance;
+
 }
@@ -12,11 +12,15 @@
 
 #include <jsonv/all.hpp>
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <cstdlib>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <map>
+#include <new>
 #include <random>
 #include <sstream>
 
@@ -24,6 +28,27 @@
 
 using namespace jsonv;
 
+/** The number of calls to the global \c operator \c new, which is replaced below to count them. **/
+static std::atomic<std::size_t> allocation_count{0};
+
+void* operator new(std::size_t size)
+{
+    ++allocation_count;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
 struct generated_json_settings
 {
     std::uniform_int_distribution<int> kind_distribution{0, 6};
@@ -196,6 +221,174 @@ static std::string get_encoded_json()
     return encoded;
 }
 
+/** Find every key of every object in \a tree, returning the number of lookups done. **/
+static std::size_t lookup_all_keys(const value& tree)
+{
+    std::size_t count = 0;
+    if (tree.kind() == kind::object)
+    {
+        for (const value::object_value_type& entry : tree.as_object())
+        {
+            if (tree.find(entry.first) != tree.end_object())
+                ++count;
+            count += lookup_all_keys(entry.second);
+        }
+    }
+    else if (tree.kind() == kind::array)
+    {
+        for (const value& sub : tree.as_array())
+            count += lookup_all_keys(sub);
+    }
+    return count;
+}
+
+/** Report the memory used by a parsed tree and the time it takes to look up object members. These numbers depend on
+ *  how the library was built (see \c JSONV_OBJECT_USE_FLAT_MAP), so compare builds with and without
+ *  \c USE_FLAT_OBJECT_STORAGE.
+**/
+static void object_layout_test(const std::string& encoded, int loop_count)
+{
+    std::string name = JSONV_OBJECT_USE_FLAT_MAP ? "JSONV-objects-flat" : "JSONV-objects-map";
+    
+    // Everything in the tree comes from the arena, so the bytes it gave out are the size of the tree, including buffers
+    // left behind when a container grows (long strings are not counted, but are the same for both layouts). Lookups are
+    // timed on a regular tree, since allocating from an arena gives the nodes of a std::map much better locality than
+    // they usually have.
+    std::size_t tree_bytes = 0;
+    {
+        arena region;
+        value tree = parse(encoded, region);
+        tree_bytes = region.bytes_allocated();
+    }
+    value tree = parse(encoded);
+    
+    std::cout << std::endl;
+    stopwatch watch;
+    std::size_t lookups = 0;
+    for (int idx = 1; idx <= loop_count; ++idx)
+    {
+        std::cout << '\r' << name << "..." << idx << '/' << loop_count;
+        std::cout.flush();
+        auto ticker = watch.start();
+        lookups = lookup_all_keys(tree);
+    }
+    std::cout << std::endl;
+    
+    auto average = std::chrono::duration_cast<std::chrono::duration<double>>(watch.total_time) / watch.tick_count;
+    std::cout << name << '\t' << average.count()
+              << "\tlookups=" << lookups
+              << "\tbytes=" << tree_bytes;
+}
+
+/** Create an array of records which look like rows from a database: a handful of fields, most of them short tokens
+ *  such as a status or a country code, with the occasional longer text field.
+**/
+static std::string generate_records(std::size_t record_count)
+{
+    static const char* const statuses[]  = { "active", "inactive", "pending", "banned" };
+    static const char* const countries[] = { "US", "DE", "JP", "BR", "IN" };
+    
+    std::mt19937_64 rng(42);
+    std::ostringstream ss;
+    ss << '[';
+    for (std::size_t idx = 0; idx < record_count; ++idx)
+    {
+        if (idx > 0)
+            ss << ',';
+        ss << "{\"id\":" << idx
+           << ",\"name\":\"user" << idx << '"'
+           << ",\"status\":\"" << statuses[rng() % 4] << '"'
+           << ",\"country\":\"" << countries[rng() % 5] << '"'
+           << ",\"email\":\"user" << idx << "@mail.example.com\""
+           << ",\"score\":" << (rng() % 1000) / 10.0
+           << '}';
+    }
+    ss << ']';
+    return ss.str();
+}
+
+/** Report the number of allocations it takes to parse and to copy a record-style document. Strings short enough to be
+ *  stored inside of a \c value do not allocate, so this is mostly a count of the objects and the long strings.
+**/
+static void record_allocation_test(int loop_count)
+{
+    const std::string name = "JSONV-records";
+    const std::size_t record_count = 10000;
+    std::string encoded = generate_records(record_count);
+    
+    std::cout << std::endl;
+    stopwatch watch;
+    std::size_t parse_allocations = 0;
+    std::size_t copy_allocations = 0;
+    for (int idx = 1; idx <= loop_count; ++idx)
+    {
+        std::cout << '\r' << name << "..." << idx << '/' << loop_count;
+        std::cout.flush();
+        
+        std::size_t start_count = allocation_count;
+        value tree;
+        {
+            auto ticker = watch.start();
+            tree = parse(encoded);
+        }
+        parse_allocations = allocation_count - start_count;
+        
+        start_count = allocation_count;
+        value copy = tree;
+        copy_allocations = allocation_count - start_count;
+    }
+    std::cout << std::endl;
+    
+    auto average = std::chrono::duration_cast<std::chrono::duration<double>>(watch.total_time) / watch.tick_count;
+    std::cout << name << '\t' << average.count()
+              << "\trecords=" << record_count
+              << "\tparse_allocations=" << parse_allocations
+              << "\tcopy_allocations=" << copy_allocations;
+}
+
+/** Report the throughput of encoding a parsed tree, once with \c to_string and once with a \c buffer_encoder which is
+ *  reused for every loop.
+**/
+static void encode_test(const std::string& encoded, int loop_count)
+{
+    value tree = parse(encoded);
+    buffer_encoder buffer;
+    
+    auto run = [&] (const std::string& name, const std::function<std::size_t ()>& encode_once)
+               {
+                   std::cout << std::endl;
+                   stopwatch watch;
+                   std::size_t output_size = 0;
+                   for (int idx = 1; idx <= loop_count; ++idx)
+                   {
+                       std::cout << '\r' << name << "..." << idx << '/' << loop_count;
+                       std::cout.flush();
+                       auto ticker = watch.start();
+                       output_size = encode_once();
+                   }
+                   std::cout << std::endl;
+                   
+                   auto average = std::chrono::duration_cast<std::chrono::duration<double>>(watch.total_time)
+                                / watch.tick_count;
+                   std::cout << name << '\t' << average.count()
+                             << "\tbytes=" << output_size
+                             << "\tMB/s=" << output_size / average.count() / 1e6;
+               };
+    
+    run("JSONV-encode-to_string", [&] { return to_string(tree).size(); });
+    run("JSONV-encode-buffer",    [&] { buffer.clear(); return buffer.encode(tree).size(); });
+    run("JSONV-encode-chunked",   [&]
+                                  {
+                                      chunked_encoder chunks(tree);
+                                      std::string     chunk;
+                                      std::size_t     size = 0;
+                                      while (chunks.next_chunk(chunk))
+                                          size += chunk.size();
+                                      return size;
+                                  }
+       );
+}
+
 int main(int argc, char** argv)
 {
     using namespace json_benchmark;
@@ -229,4 +422,13 @@ int main(int argc, char** argv)
         auto average = std::chrono::duration_cast<std::chrono::duration<double>>(watch.total_time) / watch.tick_count;
         std::cout << suite->name() << '\t' << average.count();// << std::endl;
     }
+    
+    if (filter.empty() || filter == "JSONV-objects")
+        object_layout_test(encoded, loop_count);
+    
+    if (filter.empty() || filter == "JSONV-records")
+        record_allocation_test(loop_count);
+    
+    if (filter.empty() || filter == "JSONV-encode")
+        encode_test(encoded, loop_count);
 }
@@ -0,0 +1,107 @@
+/** \file
+ *
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include "test.hpp"
+
+#include <jsonv/arena.hpp>
+#include <jsonv/parse.hpp>
+#include <jsonv/value.hpp>
+
+#include <cstdint>
+#include <memory>
+
+namespace jsonv_test
+{
+
+using namespace jsonv;
+
+static const char arena_source[] =
+    R"({"name": "a string long enough to not fit in the small string buffer",
+        "values": [1, 2.5, true, null, "short", {"nested": [[], {}]}],
+        "escaped": "tab\tnewline\n"
+       })";
+
+TEST(arena_allocate_aligned)
+{
+    arena region(256);
+    for (std::size_t alignment : { 1U, 2U, 8U, 16U, 64U })
+    {
+        void* ptr = region.allocate(3, alignment);
+        ensure_eq(0U, reinterpret_cast<std::uintptr_t>(ptr) % alignment);
+    }
+
+    // larger than a block
+    void* big = region.allocate(4096);
+    ensure(big != nullptr);
+    ensure_le(region.bytes_allocated(), region.bytes_reserved());
+
+    region.release();
+    ensure_eq(0U, region.bytes_reserved());
+}
+
+TEST(arena_parse_same_as_heap)
+{
+    arena region;
+    value expected = parse(arena_source);
+    value result   = parse(arena_source, region);
+    ensure_eq(expected, result);
+    ensure_gt(region.bytes_allocated(), 0U);
+}
+
+TEST(arena_copy_escapes)
+{
+    value escaped;
+    {
+        arena region;
+        value result = parse(arena_source, region);
+        escaped = result;
+    }
+    ensure_eq(parse(arena_source), escaped);
+}
+
+TEST(arena_mixed_with_heap)
+{
+    arena region;
+    value result = parse(arena_source, region);
+    result["heap"] = array({ 1, "two", object({ { "three", 3 } }) });
+    result["values"].push_back("a heap string long enough to need its own buffer");
+    result.erase("name");
+    ensure_eq(3, result.at("heap").at(2).at("three").as_integer());
+    ensure_eq(7U, result.at("values").size());
+}
+
+TEST(arena_factories)
+{
+    arena region;
+    value obj = object(region);
+    obj["a"] = array(region);
+    obj["a"].push_back(value(region, "x"));
+    ensure_eq(object({ { "a", array({ "x" }) } }), obj);
+}
+
+TEST(arena_parse_error_partial_result)
+{
+    std::unique_ptr<parse_error> error;
+    {
+        arena region;
+        try
+        {
+            parse("[1, 2, bogus]", region, parse_options().failure_mode(parse_options::on_error::collect_all));
+        }
+        catch (const parse_error& ex)
+        {
+            error.reset(new parse_error(ex));
+        }
+    }
+    ensure(error);
+    ensure_eq(array({ 1, 2, null }), error->partial_result());
+}
+
+}
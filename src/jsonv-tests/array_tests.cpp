@@ -186,6 +186,22 @@ TEST(array_push_pop)
     ensure_eq(array({ null, null, null, null, null }), arr);
 }
 
+TEST(array_reserve)
+{
+    using namespace jsonv;
+    
+    value arr = array({ 1, 2 });
+    arr.reserve(100);
+    ensure_eq(array({ 1, 2 }), arr);
+    for (int x = 3; x <= 100; ++x)
+        arr.push_back(x);
+    ensure_eq(100U, arr.size());
+    ensure_eq(100, arr[99].as_integer());
+    
+    value obj = object();
+    ensure_throws(kind_error, obj.reserve(10));
+}
+
 TEST(array_insertion)
 {
     using namespace jsonv;
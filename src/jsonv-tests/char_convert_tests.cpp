@@ -11,7 +11,10 @@
 #include "test.hpp"
 
 #include <jsonv/char_convert.hpp>
+#include <jsonv/detail/char_scan.hpp>
+#include <jsonv/detail/scope_exit.hpp>
 
+#include <random>
 #include <sstream>
 
 using jsonv::detail::decode_error;
@@ -270,3 +273,48 @@ TEST(string_decode_invalid_utf8_start)
 {
     ensure_throws(decode_error, string_decode_static("\xfe is not a UTF-8 start"));
 }
+
+TEST(string_encode_escapes_in_runs)
+{
+    ensure_eq("", string_encode_static(""));
+    ensure_eq("plain text which is long enough to be scanned a block at a time",
+              string_encode_static("plain text which is long enough to be scanned a block at a time")
+             );
+    ensure_eq(R"(a\/b\"c\\d\n\u0001\u007f\u00e9 and the rest of a longer string\t)",
+              string_encode_static("a/b\"c\\d\n\x01\x7f\xc3\xa9 and the rest of a longer string\t")
+             );
+}
+
+TEST(string_encode_same_for_every_scan_isa)
+{
+    using namespace jsonv::detail;
+    auto restore = on_scope_exit([old = active_scan_isa()] { set_scan_isa(old); });
+    
+    std::mt19937 rng(8675309);
+    std::uniform_int_distribution<int> pick(0, 14);
+    const char* const alphabet[] = { " ", "x", "y", "\"", "\\", "/", "\n", "\x01", "\x7f", "\xc3\xa9", "\xe2\x82\xac",
+                                     "\xf0\x9f\x8d\x95", "\xff", "\xe2", "abcdefghijklmnopqrstuvwxyz0123456789"
+                                   };
+    
+    for (std::size_t round = 0; round < 200; ++round)
+    {
+        std::string input;
+        for (int count = pick(rng) * 3; count > 0; --count)
+            input += alphabet[pick(rng)];
+        
+        for (bool ensure_ascii : { true, false })
+        {
+            set_scan_isa(scan_isa::scalar);
+            std::ostringstream expected;
+            string_encode(expected, input, ensure_ascii);
+            
+            for (scan_isa isa : { scan_isa::sse2, scan_isa::avx2 })
+            {
+                set_scan_isa(isa);
+                std::ostringstream actual;
+                string_encode(actual, input, ensure_ascii);
+                ensure_eq(expected.str(), actual.str());
+            }
+        }
+    }
+}
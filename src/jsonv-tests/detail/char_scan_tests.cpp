@@ -0,0 +1,150 @@
+/** \file
+ *
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv-tests/test.hpp>
+
+#include <jsonv/detail/char_scan.hpp>
+#include <jsonv/detail/scope_exit.hpp>
+
+#include <random>
+#include <string>
+
+namespace jsonv_test
+{
+
+using namespace jsonv::detail;
+
+static const scan_isa all_scan_isas[] = { scan_isa::scalar, scan_isa::sse2, scan_isa::avx2 };
+
+TEST(char_scan_string_special_every_offset)
+{
+    auto restore = jsonv::detail::on_scope_exit([old = active_scan_isa()] { set_scan_isa(old); });
+
+    for (scan_isa isa : all_scan_isas)
+    {
+        set_scan_isa(isa);
+        for (char special : { '\"', '\\' })
+        {
+            for (std::size_t offset = 0; offset < 80; ++offset)
+            {
+                std::string input(80, 'a');
+                input[offset] = special;
+                const char* found = scan_string_special(input.data(), input.data() + input.size());
+                ensure_eq(offset, std::size_t(found - input.data()));
+            }
+        }
+
+        std::string clean(70, 'x');
+        ensure(scan_string_special(clean.data(), clean.data() + clean.size()) == clean.data() + clean.size());
+    }
+}
+
+TEST(char_scan_string_unusual_every_offset)
+{
+    auto restore = jsonv::detail::on_scope_exit([old = active_scan_isa()] { set_scan_isa(old); });
+
+    for (scan_isa isa : all_scan_isas)
+    {
+        set_scan_isa(isa);
+        for (char unusual : { '\"', '\\', '\0', '\x1f', '\x7f', '\x80', '\xff' })
+        {
+            for (std::size_t offset = 0; offset < 80; ++offset)
+            {
+                std::string input(80, '~');
+                input[offset] = unusual;
+                const char* found = scan_string_unusual(input.data(), input.data() + input.size());
+                ensure_eq(offset, std::size_t(found - input.data()));
+            }
+        }
+
+        std::string clean(70, ' ');
+        ensure(scan_string_unusual(clean.data(), clean.data() + clean.size()) == clean.data() + clean.size());
+    }
+}
+
+TEST(char_scan_string_escape_every_offset)
+{
+    auto restore = jsonv::detail::on_scope_exit([old = active_scan_isa()] { set_scan_isa(old); });
+
+    for (scan_isa isa : all_scan_isas)
+    {
+        set_scan_isa(isa);
+        for (char escape : { '\"', '\\', '/', '\0', '\n', '\x1f', '\x7f', '\x80', '\xff' })
+        {
+            for (std::size_t offset = 0; offset < 80; ++offset)
+            {
+                std::string input(80, '~');
+                input[offset] = escape;
+                const char* found = scan_string_escape(input.data(), input.data() + input.size());
+                ensure_eq(offset, std::size_t(found - input.data()));
+            }
+        }
+
+        std::string clean(70, ' ');
+        ensure(scan_string_escape(clean.data(), clean.data() + clean.size()) == clean.data() + clean.size());
+    }
+}
+
+TEST(char_scan_whitespace_every_offset)
+{
+    auto restore = jsonv::detail::on_scope_exit([old = active_scan_isa()] { set_scan_isa(old); });
+
+    for (scan_isa isa : all_scan_isas)
+    {
+        set_scan_isa(isa);
+        for (std::size_t offset = 0; offset < 80; ++offset)
+        {
+            std::string input;
+            for (std::size_t idx = 0; idx < 80; ++idx)
+                input += " \t\r\n"[idx % 4];
+            input[offset] = '{';
+            const char* found = scan_whitespace(input.data(), input.data() + input.size());
+            ensure_eq(offset, std::size_t(found - input.data()));
+        }
+
+        std::string blank(70, ' ');
+        ensure(scan_whitespace(blank.data(), blank.data() + blank.size()) == blank.data() + blank.size());
+    }
+}
+
+TEST(char_scan_implementations_agree)
+{
+    auto restore = jsonv::detail::on_scope_exit([old = active_scan_isa()] { set_scan_isa(old); });
+
+    std::mt19937 rng(8675309);
+    std::uniform_int_distribution<int> pick(0, 12);
+    const char alphabet[] = { ' ', '\t', '\n', '\r', '\"', '\\', 'x', '\xe2', '\x7f', '~', '\x1f', '\x80', '/' };
+
+    for (std::size_t round = 0; round < 200; ++round)
+    {
+        std::string input(std::size_t(pick(rng)) * 13, ' ');
+        for (char& c : input)
+            c = alphabet[pick(rng)];
+
+        const char* begin = input.data();
+        const char* end   = input.data() + input.size();
+        set_scan_isa(scan_isa::scalar);
+        const char* expected_special    = scan_string_special(begin, end);
+        const char* expected_unusual    = scan_string_unusual(begin, end);
+        const char* expected_escape     = scan_string_escape(begin, end);
+        const char* expected_whitespace = scan_whitespace(begin, end);
+
+        for (scan_isa isa : all_scan_isas)
+        {
+            set_scan_isa(isa);
+            ensure(scan_string_special(begin, end) == expected_special);
+            ensure(scan_string_unusual(begin, end) == expected_unusual);
+            ensure(scan_string_escape(begin, end) == expected_escape);
+            ensure(scan_whitespace(begin, end) == expected_whitespace);
+        }
+    }
+}
+
+}
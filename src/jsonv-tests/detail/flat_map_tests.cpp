@@ -0,0 +1,154 @@
+/** \file
+ *
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv-tests/test.hpp>
+
+#include <jsonv/detail/flat_map.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+
+namespace jsonv_test
+{
+
+using string_flat_map = jsonv::detail::flat_map<std::string,
+                                                int,
+                                                std::less<std::string>,
+                                                std::allocator<std::pair<const std::string, int>>
+                                               >;
+
+TEST(flat_map_same_as_map)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> key_dist(0, 200);
+
+    string_flat_map            flat;
+    std::map<std::string, int> expected;
+    for (int idx = 0; idx < 2000; ++idx)
+    {
+        std::string key = std::to_string(key_dist(rng));
+        switch (idx % 4)
+        {
+        case 0:
+            ensure_eq(expected.insert({ key, idx }).second, flat.insert({ key, idx }).second);
+            break;
+        case 1:
+            flat[key] = idx;
+            expected[key] = idx;
+            break;
+        case 2:
+            ensure_eq(expected.erase(key), flat.erase(key));
+            break;
+        default:
+            flat.insert(flat.end(), { key, idx });
+            expected.insert(expected.end(), { key, idx });
+            break;
+        }
+    }
+
+    ensure_eq(expected.size(), flat.size());
+    auto flat_iter = flat.begin();
+    for (const auto& entry : expected)
+    {
+        ensure_eq(entry.first, flat_iter->first);
+        ensure_eq(entry.second, flat_iter->second);
+        ensure_eq(entry.second, flat.at(entry.first));
+        ++flat_iter;
+    }
+    ensure(flat_iter == flat.end());
+}
+
+TEST(flat_map_insert_bad_hint)
+{
+    string_flat_map flat;
+    flat.insert(flat.end(), { "c", 3 });
+    flat.insert(flat.end(), { "a", 1 });
+    flat.insert(flat.begin(), { "d", 4 });
+    auto iter = flat.insert(flat.end(), { "c", 30 });
+    ensure_eq(3, iter->second);
+    ensure_eq(3U, flat.size());
+    ensure_eq("a", flat.begin()->first);
+    ensure_eq("d", (--flat.end())->first);
+}
+
+TEST(flat_map_moves_long_keys_and_values)
+{
+    // Keys and values too long for the small string optimization, so moving them around the array is visible
+    using long_flat_map = jsonv::detail::flat_map<std::string,
+                                                  std::string,
+                                                  std::less<std::string>,
+                                                  std::allocator<std::pair<const std::string, std::string>>
+                                                 >;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> key_dist(0, 300);
+
+    long_flat_map                      flat;
+    std::map<std::string, std::string> expected;
+    for (int idx = 0; idx < 3000; ++idx)
+    {
+        std::string key = "a key which is long enough to be allocated " + std::to_string(key_dist(rng));
+        if (idx % 3 == 2)
+        {
+            ensure_eq(expected.erase(key), flat.erase(key));
+        }
+        else
+        {
+            std::string value = "a value which is also long enough to be allocated " + std::to_string(idx);
+            ensure_eq(expected.insert({ key, value }).second, flat.insert({ key, value }).second);
+        }
+    }
+
+    ensure_eq(expected.size(), flat.size());
+    ensure(std::equal(expected.begin(), expected.end(), flat.begin()));
+    flat.erase(std::next(flat.begin()), std::prev(flat.end()));
+    ensure_eq(2U, flat.size());
+    ensure_eq(expected.begin()->second, flat.begin()->second);
+    ensure_eq(expected.rbegin()->second, std::prev(flat.end())->second);
+}
+
+TEST(flat_map_copy_and_move)
+{
+    string_flat_map flat;
+    flat["a"] = 1;
+    flat["b"] = 2;
+
+    string_flat_map copy = flat;
+    copy["a"] = 10;
+    copy.erase("b");
+    ensure_eq(1, flat.at("a"));
+    ensure_eq(2U, flat.size());
+    ensure_eq(1U, copy.size());
+
+    copy = flat;
+    ensure_eq(2, copy.at("b"));
+    ensure(&copy.at("b") != &flat.at("b"));
+
+    const int* b = &flat.at("b");
+    string_flat_map moved = std::move(flat);
+    ensure(b == &moved.at("b"));
+    copy = std::move(moved);
+    ensure(b == &copy.at("b"));
+    ensure_eq(2U, copy.size());
+}
+
+TEST(flat_map_at_missing_throws)
+{
+    string_flat_map flat;
+    flat["x"] = 1;
+    ensure_throws(std::out_of_range, flat.at("y"));
+    ensure_eq(0U, flat.count("y"));
+    ensure(flat.find("y") == flat.end());
+}
+
+}
@@ -0,0 +1,317 @@
+/** \file
+ *
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv-tests/test.hpp>
+
+#include <jsonv/detail/number_convert.hpp>
+
+#include <algorithm>
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace jsonv_test
+{
+
+using namespace jsonv;
+using namespace jsonv::detail;
+
+static decoded_number decode(string_view text)
+{
+    decoded_number out;
+    if (!decode_number(text, out))
+        throw std::invalid_argument(std::string("Could not decode \"") + std::string(text) + "\"");
+    return out;
+}
+
+static std::int64_t decode_integer(string_view text)
+{
+    decoded_number out = decode(text);
+    if (!out.is_integer)
+        throw std::invalid_argument(std::string("Decoded \"") + std::string(text) + "\" as a decimal");
+    return out.integer;
+}
+
+static double decode_decimal(string_view text)
+{
+    decoded_number out = decode(text);
+    if (out.is_integer)
+        throw std::invalid_argument(std::string("Decoded \"") + std::string(text) + "\" as an integer");
+    return out.decimal;
+}
+
+TEST(decode_number_integers)
+{
+    ensure_eq(0,   decode_integer("0"));
+    ensure_eq(0,   decode_integer("-0"));
+    ensure_eq(7,   decode_integer("007"));
+    ensure_eq(-42, decode_integer("-42"));
+    ensure_eq(std::numeric_limits<std::int64_t>::max(), decode_integer("9223372036854775807"));
+    ensure_eq(std::numeric_limits<std::int64_t>::min(), decode_integer("-9223372036854775808"));
+    // 2^63..2^64-1 keep the bits of the unsigned value
+    ensure_eq(std::int64_t(-1), decode_integer("18446744073709551615"));
+}
+
+TEST(decode_number_integers_too_large)
+{
+    ensure_eq(18446744073709551616.0,  decode_decimal("18446744073709551616"));
+    ensure_eq(-9223372036854775809.0,  decode_decimal("-9223372036854775809"));
+    ensure_eq(1e30,                    decode_decimal("1000000000000000000000000000000"));
+}
+
+TEST(decode_number_decimals)
+{
+    ensure_eq(0.5,      decode_decimal("0.5"));
+    ensure_eq(-12.25,   decode_decimal("-12.25"));
+    ensure_eq(1e5,      decode_decimal("1e5"));
+    ensure_eq(1e5,      decode_decimal("1E+5"));
+    ensure_eq(1.5e-7,   decode_decimal("15e-8"));
+    ensure_eq(1.2e26,   decode_decimal("12e25"));
+    ensure_eq(0.1,      decode_decimal("0.1"));
+    ensure_eq(5e-324,   decode_decimal("4.9406564584124654e-324"));
+    ensure_eq(std::numeric_limits<double>::max(), decode_decimal("1.7976931348623157e308"));
+    ensure(std::signbit(decode_decimal("-0.0")));
+    ensure_eq(0.0,      decode_decimal("0e99999999999"));
+}
+
+TEST(decode_number_malformed)
+{
+    decoded_number out;
+    for (const char* bad : { "", "-", "1.", ".5", "1e", "1e+", "1.5.5", "12a", "+1", " 1" })
+        ensure(!decode_number(bad, out));
+}
+
+TEST(decode_number_decimals_match_strtod)
+{
+    std::mt19937_64 rng(8675309);
+    std::uniform_int_distribution<std::uint64_t> bits;
+
+    for (std::size_t round = 0; round < 20000; ++round)
+    {
+        std::uint64_t raw = bits(rng);
+        double source;
+        std::memcpy(&source, &raw, sizeof source);
+        if (!std::isfinite(source))
+            continue;
+
+        for (const char* format : { "%.17g", "%.15g", "%.6e", "%.3f" })
+        {
+            char buffer[512];
+            std::snprintf(buffer, sizeof buffer, format, source);
+            std::string text = buffer;
+            if (text.find_first_of(".e") == std::string::npos)
+                text += ".0";
+
+            double expected = std::strtod(text.c_str(), nullptr);
+            ensure_eq(expected, decode_decimal(text));
+        }
+    }
+}
+
+TEST(decode_number_ignores_global_locale)
+{
+    // Use the first locale with a decimal comma which is installed; if there are none, this still checks the C locale
+    std::string original = std::setlocale(LC_NUMERIC, nullptr);
+    for (const char* name : { "de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "fr_FR.utf8", "fr_FR" })
+    {
+        if (std::setlocale(LC_NUMERIC, name))
+            break;
+    }
+
+    // These all need more than 53 bits of mantissa or an inexact power of 10, so they take the slow path
+    double precise    = decode_decimal("0.30000000000000004");
+    double tiny       = decode_decimal("4.9406564584124654e-324");
+    double long_token = decode_decimal("3.14159265358979323846264338327950288");
+    double huge       = decode_decimal("1e400");
+    std::setlocale(LC_NUMERIC, original.c_str());
+
+    ensure_eq(0.1 + 0.2, precise);
+    ensure_eq(5e-324, tiny);
+    ensure_eq(3.141592653589793, long_token);
+    ensure_eq(std::numeric_limits<double>::infinity(), huge);
+}
+
+static std::string encode(std::int64_t value)
+{
+    char buffer[max_encoded_integer_size];
+    return std::string(buffer, encode_integer(value, buffer));
+}
+
+TEST(encode_integer_edges)
+{
+    ensure_eq("0",                    encode(std::int64_t(0)));
+    ensure_eq("-1",                   encode(std::int64_t(-1)));
+    ensure_eq("9223372036854775807",  encode(std::numeric_limits<std::int64_t>::max()));
+    ensure_eq("-9223372036854775808", encode(std::numeric_limits<std::int64_t>::min()));
+
+    // Every power of 10 and its neighbors, where the number of digits changes
+    std::uint64_t pow10 = 1;
+    for (int digits = 1; digits <= 19; ++digits, pow10 *= 10)
+    {
+        for (std::uint64_t magnitude : { pow10 - 1, pow10, pow10 + 1 })
+        {
+            if (magnitude > std::uint64_t(std::numeric_limits<std::int64_t>::max()))
+                continue;
+            std::int64_t value = std::int64_t(magnitude);
+            ensure_eq(std::to_string(value),  encode(value));
+            ensure_eq(std::to_string(-value), encode(-value));
+        }
+    }
+}
+
+TEST(encode_integer_full_range)
+{
+    std::mt19937_64 rng(8675309);
+    std::uniform_int_distribution<std::uint64_t> bits;
+    std::uniform_int_distribution<int>           width(0, 63);
+
+    for (std::size_t round = 0; round < 100000; ++round)
+    {
+        // Shift to get values of every length, not just the (overwhelmingly likely) 19 digit ones
+        std::int64_t value = std::int64_t(bits(rng) >> width(rng));
+        if (round % 2)
+            value = -value;
+        std::string text = encode(value);
+        ensure_eq(std::to_string(value), text);
+        ensure_eq(value, decode_integer(text));
+    }
+}
+
+TEST(encode_integer_unsigned_range)
+{
+    // decode_number stores 2^63..2^64-1 with the bits of the unsigned value, so these are written as negative integers
+    // and read back to the same bits
+    std::mt19937_64 rng(8675309);
+    const std::uint64_t lowest  = std::uint64_t(1) << 63;
+    const std::uint64_t highest = std::numeric_limits<std::uint64_t>::max();
+    std::uniform_int_distribution<std::uint64_t> upper(lowest, highest);
+
+    for (std::uint64_t source : { lowest, lowest + 1, highest - 1, highest })
+    {
+        std::int64_t stored = decode_integer(std::to_string(source));
+        ensure_eq(static_cast<std::int64_t>(source), stored);
+        ensure_eq(std::to_string(stored), encode(stored));
+    }
+
+    for (std::size_t round = 0; round < 100000; ++round)
+    {
+        std::uint64_t source = upper(rng);
+        std::int64_t  stored = decode_integer(std::to_string(source));
+        ensure_eq(static_cast<std::int64_t>(source), stored);
+
+        std::string text = encode(stored);
+        ensure_eq(std::to_string(stored), text);
+        ensure_eq(stored, decode_integer(text));
+        ensure_eq(source, static_cast<std::uint64_t>(decode_integer(text)));
+    }
+}
+
+static std::string encode(double value)
+{
+    char buffer[max_encoded_decimal_size];
+    return std::string(buffer, encode_decimal(value, buffer));
+}
+
+/** Get the fewest significant digits \c printf needs for \a value to read back exactly. **/
+static int shortest_printf_digits(double value)
+{
+    for (int precision = 1; ; ++precision)
+    {
+        char buffer[64];
+        std::snprintf(buffer, sizeof buffer, "%.*e", precision - 1, value);
+        if (std::strtod(buffer, nullptr) == value)
+            return precision;
+    }
+}
+
+/** Count the significant digits in the output of \c encode_decimal. **/
+static int significant_digits(const std::string& text)
+{
+    std::string digits;
+    for (char c : text.substr(0, text.find('e')))
+        if ('0' <= c && c <= '9')
+            digits += c;
+    digits.erase(0, std::min(digits.find_first_not_of('0'), digits.size()));
+    digits.erase(digits.find_last_not_of('0') + 1);
+    return std::max(1, int(digits.size()));
+}
+
+TEST(encode_decimal_formats)
+{
+    ensure_eq("0.0",                     encode(0.0));
+    ensure_eq("-0.0",                    encode(-0.0));
+    ensure_eq("2.0",                     encode(2.0));
+    ensure_eq("-12.25",                  encode(-12.25));
+    ensure_eq("0.1",                     encode(0.1));
+    ensure_eq("0.30000000000000004",     encode(0.1 + 0.2));
+    ensure_eq("0.001234",                encode(0.001234));
+    ensure_eq("1.234e-05",               encode(0.00001234));
+    ensure_eq("123456789012345.0",       encode(123456789012345.0));
+    ensure_eq("1.234567890123456e+15",   encode(1234567890123456.0));
+    ensure_eq("1e+100",                  encode(1e100));
+    ensure_eq("5e-324",                  encode(5e-324));
+    ensure_eq("2.2250738585072014e-308", encode(2.2250738585072014e-308));
+    ensure_eq("1.7976931348623157e+308", encode(std::numeric_limits<double>::max()));
+    ensure_eq("9.007199254740992e+15",   encode(9007199254740992.0));
+}
+
+TEST(encode_decimal_round_trip)
+{
+    std::mt19937_64 rng(8675309);
+    std::uniform_int_distribution<std::uint64_t> bits;
+    std::uniform_int_distribution<int>           small_digits(1, 8);
+    std::uniform_int_distribution<int>           small_exponent(-20, 20);
+
+    std::size_t not_shortest = 0;
+    std::size_t count        = 0;
+    for (std::size_t round = 0; round < 100000; ++round)
+    {
+        // Alternate between every possible bit pattern and the short decimals which are common in real data
+        double source;
+        if (round % 2 == 0)
+        {
+            std::uint64_t raw = bits(rng);
+            std::memcpy(&source, &raw, sizeof source);
+            if (!std::isfinite(source))
+                continue;
+        }
+        else
+        {
+            int digits = small_digits(rng);
+            std::int64_t mantissa = std::int64_t(bits(rng) % std::uint64_t(std::pow(10.0, digits)));
+            source = std::strtod((std::to_string(mantissa) + "e" + std::to_string(small_exponent(rng))).c_str(),
+                                 nullptr
+                                );
+        }
+
+        std::string text = encode(source);
+        ensure(text.size() <= max_encoded_decimal_size);
+        double decoded = decode_decimal(text);
+        ensure_eq(source, decoded);
+        ensure_eq(std::signbit(source), std::signbit(decoded));
+
+        int actual_digits = significant_digits(text);
+        ensure(actual_digits <= 17);
+        if (actual_digits > shortest_printf_digits(source))
+            ++not_shortest;
+        ++count;
+    }
+    // Grisu2 misses the shortest output for values which are very close to halfway between two doubles. The short
+    // decimals with large exponents are often exactly halfway, so they miss much more than the average.
+    ensure(not_shortest * 100 < count);
+}
+
+}
@@ -162,4 +162,26 @@ TEST(token_attempt_match_comment_slash_invalid)
     ensure(result == match_result::unmatched);
 }
 
+TEST(token_attempt_match_string_verbatim)
+{
+    auto check = [] (string_view input)
+                 {
+                     token_kind kind;
+                     std::size_t length;
+                     bool verbatim;
+                     match_result result = attempt_match(input.data(), input.data() + input.size(), kind, length, verbatim);
+                     return result == match_result::complete && kind == token_kind::string && verbatim;
+                 };
+    
+    ensure(check(R"("")"));
+    ensure(check(R"("plain key")"));
+    ensure(check(R"("a string which is long enough to be scanned a block at a time")"));
+    ensure(!check(R"("escaped\"quote")"));
+    ensure(!check(R"("newline\n")"));
+    ensure(!check("\"tab\tin it\""));
+    ensure(!check("\"caf\xc3\xa9\""));
+    ensure(!check("\"del\x7f\""));
+    ensure(!check(R"("unterminated)"));
+}
+
 }
@@ -0,0 +1,157 @@
+/** \file
+ *  
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include "test.hpp"
+
+#include <jsonv/array.hpp>
+#include <jsonv/document_reader.hpp>
+#include <jsonv/object.hpp>
+#include <jsonv/parse.hpp>
+#include <jsonv/tokenizer.hpp>
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace jsonv_test
+{
+
+using namespace jsonv;
+
+TEST(document_reader_concatenated)
+{
+    std::string src = R"({"a": 1}{"b": [2]}[3]  "four" /* five */ 5 null
+true)";
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        std::istringstream stream(src);
+        std::unique_ptr<document_reader> documents(pass == 0 ? new document_reader(src)
+                                                             : new document_reader(stream)
+                                                  );
+        value x;
+        ensure(documents->next(x));
+        ensure_eq(object({ { "a", 1 } }), x);
+        ensure(documents->next(x));
+        ensure_eq(object({ { "b", array({ 2 }) } }), x);
+        ensure(documents->next(x));
+        ensure_eq(array({ 3 }), x);
+        ensure(documents->next(x));
+        ensure_eq(value("four"), x);
+        ensure(documents->next(x));
+        ensure_eq(value(5), x);
+        ensure(documents->next(x));
+        ensure_eq(value(), x);
+        ensure(documents->next(x));
+        ensure_eq(value(true), x);
+        ensure(!documents->next(x));
+        ensure(!documents->next(x));
+        ensure_eq(7U, documents->count());
+    }
+}
+
+TEST(document_reader_empty)
+{
+    value x;
+    ensure(!document_reader(string_view("")).next(x));
+    ensure(!document_reader(string_view(" \n\t /* nothing */ ")).next(x));
+}
+
+TEST(document_reader_from_tokenizer)
+{
+    tokenizer tokens(string_view("[1] [2] [3]"));
+    document_reader documents(tokens);
+    value x;
+    ensure(documents.next(x));
+    ensure_eq(array({ 1 }), x);
+    // the tokenizer is left at the end of the document
+    ensure(tokens.current().kind == token_kind::array_end);
+    ensure(documents.next(x));
+    ensure_eq(array({ 2 }), x);
+}
+
+TEST(document_reader_problems)
+{
+    document_reader documents(string_view("[1]\n{\"a\" 2}\n[3]"));
+    value x;
+    ensure(documents.next(x));
+    try
+    {
+        documents.next(x);
+        ensure(false);
+    }
+    catch (const parse_error& err)
+    {
+        ensure_eq(2U, err.problems().at(0).line());
+        ensure_eq(6U, err.problems().at(0).column());
+    }
+    ensure_throws(std::logic_error, documents.next(x));
+    
+    auto strict = parse_options::create_strict();
+    document_reader scalar_documents(string_view("[1] 2"), strict);
+    ensure(scalar_documents.next(x));
+    ensure_throws(parse_error, scalar_documents.next(x));
+    document_reader strict_documents(string_view("[1] /* no */ [2]"), strict);
+    ensure(strict_documents.next(x));
+    ensure_throws(parse_error, strict_documents.next(x));
+    
+    // Ignoring problems would leave the input somewhere inside of the bad document, so they are thrown anyway
+    for (auto mode : { parse_options::on_error::ignore, parse_options::on_error::collect_all })
+    {
+        document_reader lenient(string_view("[1, 2 3] [4]"), parse_options().failure_mode(mode));
+        ensure_throws(parse_error, lenient.next(x));
+        ensure_throws(std::logic_error, lenient.next(x));
+    }
+}
+
+TEST(document_reader_many)
+{
+    std::ostringstream src;
+    for (int idx = 0; idx < 10000; ++idx)
+        src << R"({"id":)" << idx << R"(,"values":[1,2,3]})";
+    std::istringstream stream(src.str());
+    document_reader documents(stream);
+    value x;
+    for (int idx = 0; idx < 10000; ++idx)
+    {
+        ensure(documents.next(x));
+        ensure_eq(value(idx), x.at("id"));
+    }
+    ensure(!documents.next(x));
+}
+
+TEST(document_reader_stream_borrow_strings)
+{
+    tokenizer::size_type original_buffer_size = tokenizer::min_buffer_size();
+    tokenizer::set_min_buffer_size(16);
+    std::string src = R"("a first document which is too long to fit in a value" ["and a second one which is read )"
+                      R"(after the buffer has been refilled"] {"third": "which refills the buffer once again"})";
+    std::vector<value> expected;
+    std::vector<value> documents;
+    value x;
+    for (document_reader reader(src); reader.next(x); )
+        expected.push_back(x);
+    
+    std::istringstream stream(src);
+    for (document_reader reader(stream, parse_options().borrow_strings(true)); reader.next(x); )
+        documents.push_back(x);
+    std::istringstream tokenizer_stream(src);
+    tokenizer tokens(tokenizer_stream);
+    for (document_reader reader(tokens, parse_options().borrow_strings(true)); reader.next(x); )
+        documents.push_back(x);
+    tokenizer::set_min_buffer_size(original_buffer_size);
+    
+    ensure_eq(3U, expected.size());
+    ensure_eq(6U, documents.size());
+    for (std::size_t idx = 0; idx < documents.size(); ++idx)
+        ensure_eq(expected[idx % 3], documents[idx]);
+}
+
+}
@@ -8,16 +8,24 @@
  *
  *  \author Travis Gockel (travis@gockelhut.com)
 **/
+#include "filesystem_util.hpp"
 #include "test.hpp"
 
+#include <jsonv/array.hpp>
 #include <jsonv/encode.hpp>
+#include <jsonv/mapped_file.hpp>
+#include <jsonv/object.hpp>
 #include <jsonv/parse.hpp>
 #include <jsonv/value.hpp>
 
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <locale>
+#include <random>
 #include <sstream>
+#include <stdexcept>
 
 namespace jsonv_test
 {
@@ -104,4 +112,185 @@ TEST(encode_invalid_utf8_uses_replacement_at_end)
     ensure_eq(output, "\"\\u00e8\"");
 }
 
+TEST(encode_buffer_same_as_ostream)
+{
+    jsonv::buffer_encoder buffer;
+    for (const char* name : { "blns.json", "generated.json", "paths.json" })
+    {
+        jsonv::mapped_file file(test_path(name));
+        jsonv::value val = jsonv::object({ { "file",  jsonv::parse(file.contents()) },
+                                           { "extra", jsonv::array({ 1.5, -2, std::nan(""), 1e300, "\xf0\x9f\x8d\x95",
+                                                                     std::int64_t(-9223372036854775807 - 1)
+                                                                   }
+                                                                  )
+                                           }
+                                         }
+                                        );
+        
+        for (bool ensure_ascii : { true, false })
+        {
+            std::ostringstream ss;
+            jsonv::ostream_encoder stream_encoder(ss);
+            stream_encoder.ensure_ascii(ensure_ascii);
+            stream_encoder.encode(val);
+            
+            buffer.clear();
+            buffer.ensure_ascii(ensure_ascii);
+            ensure_eq(ss.str(), std::string(buffer.encode(val)));
+        }
+    }
+}
+
+TEST(encode_buffer_reuses_capacity)
+{
+    auto val = jsonv::parse(k_some_json);
+    jsonv::buffer_encoder buffer;
+    std::string expected = jsonv::to_string(val);
+    ensure_eq(expected, std::string(buffer.encode(val)));
+    ensure_eq(expected + expected, std::string(buffer.encode(val)));
+    
+    auto capacity = buffer.capacity();
+    auto data     = buffer.text().data();
+    buffer.clear();
+    ensure_eq(0U, buffer.size());
+    ensure_eq(expected, std::string(buffer.encode(val)));
+    ensure_eq(capacity, buffer.capacity());
+    ensure(data == buffer.text().data());
+}
+
+TEST(encode_buffer_fixed_span)
+{
+    auto val = jsonv::parse(k_some_json);
+    std::string expected = jsonv::to_string(val);
+    
+    char storage[512];
+    jsonv::buffer_encoder buffer(storage, sizeof storage);
+    ensure(buffer.encode(val).data() == storage);
+    ensure_eq(expected, std::string(buffer.text()));
+    
+    jsonv::buffer_encoder small(storage, expected.size() - 1);
+    ensure_throws(std::length_error, small.encode(val));
+    ensure_eq(expected.substr(0, small.size()), std::string(small.text()));
+    ensure_throws(std::length_error, small.reserve(expected.size()));
+}
+
+TEST(encode_decimals_round_trip)
+{
+    std::mt19937_64 rng(8675309);
+    std::uniform_int_distribution<std::uint64_t> bits;
+    std::uniform_real_distribution<double>       usual(-1000.0, 1000.0);
+    
+    jsonv::value val = jsonv::array();
+    for (std::size_t idx = 0; idx < 5000; ++idx)
+    {
+        std::uint64_t raw = bits(rng);
+        double source;
+        std::memcpy(&source, &raw, sizeof source);
+        if (std::isfinite(source))
+            val.push_back(source);
+        val.push_back(usual(rng));
+        val.push_back(std::round(usual(rng)));
+    }
+    
+    jsonv::buffer_encoder buffer;
+    for (const std::string& encoded : { jsonv::to_string(val), std::string(buffer.encode(val)) })
+    {
+        jsonv::value decoded = jsonv::parse(encoded);
+        ensure_eq(val.size(), decoded.size());
+        for (jsonv::value::size_type idx = 0; idx < val.size(); ++idx)
+        {
+            ensure(decoded[idx].kind() == jsonv::kind::decimal);
+            ensure_eq(val[idx].as_decimal(), decoded[idx].as_decimal());
+        }
+    }
+}
+
+TEST(encode_integers)
+{
+    // Values from 2^63..2^64-1 are stored with the bits of the unsigned value, so they come out negative
+    auto val = jsonv::parse("[0, -7, 1234567890, 9223372036854775807, -9223372036854775808, 9223372036854775808, "
+                            "18446744073709551615]"
+                           );
+    std::string expected = "[0,-7,1234567890,9223372036854775807,-9223372036854775808,-9223372036854775808,-1]";
+    ensure_eq(expected, jsonv::to_string(val));
+    
+    jsonv::buffer_encoder buffer;
+    ensure_eq(expected, std::string(buffer.encode(val)));
+    ensure_eq(val, jsonv::parse(buffer.text()));
+}
+
+TEST(encode_chunked_same_as_to_string)
+{
+    // Every chunk but the last must be full, and the chunks together must be the whole encoding
+    auto check = [&] (const jsonv::value& val, std::size_t chunk_size, bool ensure_ascii)
+                 {
+                     std::ostringstream ss;
+                     jsonv::ostream_encoder stream_encoder(ss);
+                     stream_encoder.ensure_ascii(ensure_ascii);
+                     stream_encoder.encode(val);
+                     
+                     jsonv::chunked_encoder chunks(val, chunk_size);
+                     chunks.ensure_ascii(ensure_ascii);
+                     std::string chunk;
+                     std::string encoded;
+                     while (chunks.next_chunk(chunk))
+                     {
+                         ensure(encoded.size() % chunk_size == 0);
+                         ensure(chunk.size() <= chunk_size);
+                         encoded += chunk;
+                     }
+                     ensure(chunk.empty());
+                     ensure(chunks.done());
+                     ensure(!chunks.next_chunk(chunk));
+                     ensure_eq(ss.str(), encoded);
+                 };
+    
+    std::string long_text;
+    for (int idx = 0; idx < 2000; ++idx)
+        long_text += "text \"\xf0\x9f\x8d\x95\" \xc3\xa9\t\\/\x01";
+    jsonv::value extra = jsonv::object({ { "long",  long_text },
+                                         { "empty", jsonv::array({ jsonv::array(), jsonv::object(), "" }) },
+                                         { "",      jsonv::array({ 1.5, -2, jsonv::null, true, false }) }
+                                       }
+                                      );
+    for (const char* name : { "blns.json", "generated.json", "paths.json" })
+    {
+        jsonv::mapped_file file(test_path(name));
+        jsonv::value val = jsonv::object({ { "file", jsonv::parse(file.contents()) }, { "extra", extra } });
+        for (std::size_t chunk_size : { 1, 7, 4096 })
+            for (bool ensure_ascii : { true, false })
+                check(val, chunk_size, ensure_ascii);
+    }
+    
+    for (const jsonv::value& val : { jsonv::null, jsonv::value(5), jsonv::value(long_text),
+                                     jsonv::value(jsonv::array()), jsonv::value(jsonv::object())
+                                   }
+        )
+    {
+        check(val, 5, true);
+    }
+}
+
+TEST(encode_chunked_deep_nesting)
+{
+    // Building and destroying a value this deep is recursive, so keep it to what the stack can handle
+    const std::size_t depth = 2000;
+    jsonv::value val = jsonv::array();
+    jsonv::value* innermost = &val;
+    for (std::size_t idx = 0; idx < depth; ++idx)
+    {
+        innermost->push_back(jsonv::object({ { "a", jsonv::array() } }));
+        innermost = &(*innermost)[innermost->size() - 1].at("a");
+    }
+    
+    jsonv::chunked_encoder chunks(val, 100);
+    ensure_eq(100U, chunks.chunk_size());
+    ensure(!chunks.done());
+    std::string chunk;
+    std::string encoded;
+    while (chunks.next_chunk(chunk))
+        encoded += chunk;
+    ensure_eq(jsonv::to_string(val), encoded);
+}
+
 }
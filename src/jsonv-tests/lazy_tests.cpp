@@ -0,0 +1,254 @@
+/** \file
+ *  
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include "filesystem_util.hpp"
+#include "test.hpp"
+
+#include <jsonv/array.hpp>
+#include <jsonv/lazy.hpp>
+#include <jsonv/mapped_file.hpp>
+#include <jsonv/object.hpp>
+#include <jsonv/parse.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace jsonv_test
+{
+
+using namespace jsonv;
+
+TEST(lazy_materialize_same_as_parse)
+{
+    for (const char* name : { "blns.json", "generated.json", "paths.json" })
+    {
+        mapped_file file(test_path(name));
+        lazy_document doc(file.contents());
+        ensure_eq(parse(file.contents()), doc.root().materialize());
+    }
+}
+
+TEST(lazy_access)
+{
+    std::string src = R"({"a": [1, 2.5, "x\ty", null, true], "b": {"c": {}, "d!": false}, "a": "dup"})";
+    lazy_document doc(src);
+    lazy_value root = doc.root();
+    ensure(root.kind() == kind::object);
+    ensure_eq(3U, root.size());
+    ensure_eq(16U, doc.index_size());
+    
+    lazy_value a = root.at("a");
+    ensure(a.kind() == kind::array);
+    ensure_eq(5U, a.size());
+    ensure(a.at(0).kind() == kind::integer);
+    ensure_eq(1, a.at(0).as_integer());
+    ensure(a.at(1).kind() == kind::decimal);
+    ensure_eq(2.5, a.at(1).as_decimal());
+    ensure_eq(1.0, a.at(0).as_decimal());
+    ensure_eq(std::string("x\ty"), a.at(2).as_string());
+    ensure_eq(3U, a.at(2).size());
+    ensure(a.at(3).is_null());
+    ensure(a.at(4).as_boolean());
+    ensure_eq(std::string(R"("x\ty")"), std::string(a.at(2).text()));
+    
+    ensure_eq(1U, root.at("b").count("d!"));
+    ensure_eq(0U, root.at("b").count("d"));
+    ensure(!root.at("b").at("d!").as_boolean());
+    ensure_eq(object(), root.at("b").at("c").materialize());
+}
+
+TEST(lazy_at_path)
+{
+    mapped_file file(test_path("paths.json"));
+    value      expected = parse(file.contents());
+    lazy_document doc(file.contents());
+    
+    for (const char* p : { ".a", ".b", ".b[2][1].x", ".c[\"d e\"]", ".b[3]", ".c.x", ".e" })
+    {
+        ensure_eq(expected.count_path(p), doc.root().count_path(p));
+        if (expected.count_path(p))
+            ensure_eq(expected.at_path(p), doc.root().at_path(p).materialize());
+        else
+            ensure_throws(std::out_of_range, doc.root().at_path(p));
+    }
+    ensure_throws(kind_error, doc.root().at_path(".a.x"));
+}
+
+TEST(lazy_at_path_generated)
+{
+    mapped_file file(test_path("generated.json"));
+    value      expected = parse(file.contents());
+    lazy_document doc(file.contents());
+    
+    for (value::size_type idx = 0; idx < expected.size(); ++idx)
+    {
+        path p({ path_element(idx), path_element("name") });
+        ensure_eq(expected.count_path(p), doc.root().count_path(p));
+        if (expected.count_path(p))
+            ensure_eq(expected.at_path(p), doc.root().at_path(p).materialize());
+    }
+}
+
+TEST(lazy_iterators)
+{
+    lazy_document doc(string_view(R"({"x": [1, [2, 3], {"y": 4}], "z": "w"})"));
+    
+    std::vector<std::string> keys;
+    for (auto iter = doc.root().begin_object(); iter != doc.root().end_object(); ++iter)
+        keys.push_back((*iter).first);
+    ensure_eq(2U, keys.size());
+    ensure_eq(std::string("x"), keys[0]);
+    ensure_eq(std::string("z"), keys[1]);
+    
+    value elements = array();
+    lazy_value x = doc.root().at("x");
+    for (auto iter = x.begin_array(); iter != x.end_array(); ++iter)
+        elements.push_back((*iter).materialize());
+    ensure_eq(array({ 1, array({ 2, 3 }), object({ { "y", 4 } }) }), elements);
+    
+    lazy_document empty(string_view("[]"));
+    ensure(empty.root().begin_array() == empty.root().end_array());
+}
+
+TEST(lazy_cached_and_indexed)
+{
+    // A large object has its keys put in a table, which must find the same member as a search would
+    std::string list_src = R"([[0, 1], "zero", [[2]], 3.5, {"k": [4]}])";
+    std::string src = R"({"list": )" + list_src + R"(, "na\u006de": "escaped", "name": "dup")";
+    for (int idx = 0; idx < 20; ++idx)
+        src += ", \"key" + std::to_string(idx) + "\": " + std::to_string(idx);
+    src += "}";
+    value expected = parse(list_src);
+    lazy_document doc(src);
+    lazy_value root = doc.root();
+    
+    lazy_value list = root.at("list");
+    for (lazy_value::size_type idx = 0; idx < list.size(); ++idx)
+        ensure_eq(expected.at(idx), list.at(idx).materialize());
+    ensure_eq(2, list.at(2).at(0).at(0).as_integer());
+    ensure_eq(4, list.at(4).at("k").at(0).as_integer());
+    ensure_throws(std::out_of_range, list.at(5));
+    
+    ensure_eq(std::string("escaped"), root.at("name").as_string());
+    for (int idx = 0; idx < 20; ++idx)
+        ensure_eq(idx, root.at("key" + std::to_string(idx)).as_integer());
+    ensure_eq(0U, root.count("key20"));
+    
+    // strings are decoded once and kept by the document
+    const std::string& first = list.at(1).as_string();
+    ensure(&first == &list.at(1).as_string());
+    ensure_eq(std::string("zero"), first);
+    ensure_eq(3.5, list.at(3).as_decimal());
+    ensure(list.at(3).kind() == kind::decimal);
+}
+
+TEST(lazy_threads)
+{
+    // Many threads decode the same nodes at once, so each one is cached by whichever gets there first
+    std::string src = "[";
+    for (int idx = 0; idx < 500; ++idx)
+    {
+        src += idx ? ", {" : "{";
+        for (int key = 0; key < 20; ++key)
+            src += (key ? ", \"key" : "\"key") + std::to_string(key) + "\": \"record " + std::to_string(idx) + "\"";
+        src += ", \"id\": " + std::to_string(idx) + ".5}";
+    }
+    src += "]";
+    lazy_document doc(src);
+    
+    std::vector<const std::string*> first(500);
+    std::vector<std::thread> workers;
+    std::vector<int> failures(4);
+    for (int worker = 0; worker < 4; ++worker)
+    {
+        workers.emplace_back([&, worker]
+                             {
+                                 for (int idx = 0; idx < 500; ++idx)
+                                 {
+                                     lazy_value record = doc.root().at(idx);
+                                     const std::string& name = record.at("key7").as_string();
+                                     if (name != "record " + std::to_string(idx))
+                                         ++failures[worker];
+                                     if (record.at("id").as_decimal() != idx + 0.5)
+                                         ++failures[worker];
+                                     if (worker == 0)
+                                         first[idx] = &name;
+                                 }
+                             }
+                            );
+    }
+    for (std::thread& worker : workers)
+        worker.join();
+    
+    for (int worker = 0; worker < 4; ++worker)
+        ensure_eq(0, failures[worker]);
+    for (int idx = 0; idx < 500; ++idx)
+        ensure(first[idx] == &doc.root().at(idx).at("key7").as_string());
+}
+
+TEST(lazy_kind_errors)
+{
+    lazy_document doc(string_view(R"({"a": [1], "s": "text"})"));
+    ensure_throws(kind_error, doc.root().at(0));
+    ensure_throws(kind_error, doc.root().at("a").at("b"));
+    ensure_throws(kind_error, doc.root().as_string());
+    ensure_throws(kind_error, doc.root().at("s").as_integer());
+    ensure_throws(kind_error, doc.root().at("s").begin_array());
+    ensure_throws(kind_error, doc.root().at("a").at(0).size());
+    ensure_throws(std::out_of_range, doc.root().at("a").at(1));
+    ensure_throws(std::out_of_range, doc.root().at("b"));
+    ensure_throws(std::out_of_range, doc.root().at_path(".a[3]"));
+    ensure_eq(0U, doc.root().count_path(".s.x"));
+}
+
+TEST(lazy_structure_problems)
+{
+    auto strict = parse_options::create_strict();
+    for (const char* src : { "", "[1, 2,]", R"({"a" 1})", R"({"a": 1 "b": 2})", "[1, [2", "[1] 2", "[01]",
+                             R"([1, {"a": [2)", R"({"a": })", "[nul]", "[1 2]", R"({1: 2})", "4"
+                           }
+        )
+    {
+        ensure_throws(parse_error, lazy_document(string_view(src), strict));
+    }
+    
+    ensure_throws(parse_error, lazy_document(string_view("[[[1]]]"), parse_options().max_structure_depth(3)));
+    lazy_document(string_view("[[1]]"), parse_options().max_structure_depth(3));
+    lazy_document(string_view("[1, 2,]"), parse_options().comma_policy(parse_options::commas::allow_trailing));
+    lazy_document(string_view("[1] 2"), parse_options().complete_parse(false));
+}
+
+TEST(lazy_decode_problems_on_access)
+{
+    lazy_document doc(string_view(R"(["fine", "bad\q", 1])"));
+    ensure_eq(std::string("fine"), doc.root().at(0).as_string());
+    ensure_eq(1, doc.root().at(2).as_integer());
+    ensure_throws(parse_error, doc.root().at(1).as_string());
+    ensure_throws(parse_error, doc.root().materialize());
+}
+
+TEST(lazy_problem_position)
+{
+    try
+    {
+        lazy_document(string_view("[1,\n  2,\n  ]"), parse_options().comma_policy(parse_options::commas::strict));
+        ensure(false);
+    }
+    catch (const parse_error& err)
+    {
+        const parse_error::problem& p = err.problems().at(0);
+        ensure_eq(3U,  p.line());
+        ensure_eq(3U,  p.column());
+        ensure_eq(11U, p.character());
+    }
+}
+
+}
@@ -0,0 +1,81 @@
+/** \file
+ *
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include "filesystem_util.hpp"
+#include "test.hpp"
+
+#include <jsonv/algorithm.hpp>
+#include <jsonv/mapped_file.hpp>
+#include <jsonv/parse.hpp>
+#include <jsonv/value.hpp>
+
+#include <fstream>
+#include <system_error>
+
+namespace jsonv_test
+{
+
+using namespace jsonv;
+
+TEST(parse_file_same_as_stream)
+{
+    for (const char* name : { "blns.json", "generated.json" })
+    {
+        std::ifstream src_file(test_path(name));
+        ensure_eq(parse(src_file), parse_file(test_path(name)));
+    }
+}
+
+TEST(parse_file_missing_throws)
+{
+    ensure_throws(std::system_error, parse_file(test_path("this-file-does-not-exist.json")));
+}
+
+TEST(mapped_file_borrow_strings)
+{
+    mapped_file file(test_path("generated.json"));
+    value owned    = parse(file.contents());
+    value borrowed = parse(file.contents(), parse_options().borrow_strings(true));
+    ensure_eq(owned, borrowed);
+    
+    // Some strings must refer to the mapping and none of them should be copies of escaped text
+    std::size_t in_mapping = 0;
+    traverse(borrowed,
+             [&] (const path&, const value& sub)
+             {
+                 if (!sub.is_string())
+                     return;
+                 
+                 string_view text = sub.as_string_view();
+                 if (file.contents().data() <= text.data() && text.data() < file.contents().data() + file.size())
+                 {
+                     ++in_mapping;
+                     ensure(text.find('\\') == string_view::npos);
+                 }
+             },
+             true
+            );
+    ensure(in_mapping > 0);
+}
+
+TEST(mapped_file_move)
+{
+    mapped_file file(test_path("paths.json"));
+    string_view contents = file.contents();
+    
+    mapped_file moved(std::move(file));
+    ensure(moved.contents() == contents);
+    ensure_eq(0U, file.size());
+    
+    file = std::move(moved);
+    ensure(file.contents() == contents);
+}
+
+}
@@ -0,0 +1,177 @@
+/** \file
+ *  
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include "test.hpp"
+
+#include <jsonv/array.hpp>
+#include <jsonv/ndjson.hpp>
+#include <jsonv/object.hpp>
+#include <jsonv/parse.hpp>
+
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace jsonv_test
+{
+
+using namespace jsonv;
+
+static const std::string ndjson_source = "{\"a\": 1}\n"
+                                         "[1, 2]\r\n"
+                                         "\n"
+                                         "   \n"
+                                         "\"text\"\n"
+                                         "{\"b\": [tru]}\n"
+                                         "4 5\n"
+                                         "null";
+
+/** Describe each record as its line and either the value or the position of its first problem. **/
+static std::string describe(const std::vector<ndjson_reader::record>& records)
+{
+    std::ostringstream os;
+    for (const ndjson_reader::record& rec : records)
+    {
+        os << rec.line << ' ';
+        if (rec.ok())
+            os << rec.result;
+        else
+            os << "problem at " << rec.problems.at(0).line() << ':' << rec.problems.at(0).column()
+               << " \"" << ndjson_source.substr(rec.problems.at(0).character(), 3) << '"';
+        os << '\n';
+    }
+    return os.str();
+}
+
+static const std::string ndjson_records = "1 {\"a\":1}\n"
+                                          "2 [1,2]\n"
+                                          "5 \"text\"\n"
+                                          "6 problem at 6:8 \"tru\"\n"
+                                          "7 problem at 7:3 \"5\nn\"\n"
+                                          "8 null\n";
+
+TEST(ndjson_reader_next)
+{
+    ndjson_reader reader(ndjson_source);
+    std::vector<ndjson_reader::record> records;
+    ndjson_reader::record rec;
+    while (reader.next(rec))
+        records.push_back(rec);
+    ensure_eq(ndjson_records, describe(records));
+    ensure(!reader.next(rec));
+}
+
+TEST(ndjson_reader_stream)
+{
+    std::istringstream stream(ndjson_source);
+    ndjson_reader reader(stream);
+    std::vector<ndjson_reader::record> records;
+    reader.read_all([&] (ndjson_reader::record& rec) { records.push_back(rec); });
+    ensure_eq(ndjson_records, describe(records));
+}
+
+TEST(ndjson_reader_threads)
+{
+    std::ostringstream src;
+    for (int idx = 0; idx < 5000; ++idx)
+    {
+        if (idx % 97 == 0)
+            src << "{\"id\": " << idx << ", bad}\n";
+        else
+            src << "{\"id\": " << idx << ", \"name\": \"record " << idx << "\", \"tags\": [1, 2, 3]}\n";
+    }
+    std::string input = src.str();
+    
+    for (std::size_t threads : { 1U, 2U, 3U, 0U })
+    {
+        for (int from_stream = 0; from_stream < 2; ++from_stream)
+        {
+            std::istringstream stream(input);
+            std::unique_ptr<ndjson_reader> reader(from_stream ? new ndjson_reader(stream) : new ndjson_reader(input));
+            std::size_t count = 0;
+            reader->read_all([&] (ndjson_reader::record& rec)
+                             {
+                                 ensure_eq(count + 1, rec.line);
+                                 ensure_eq(count % 97 != 0, rec.ok());
+                                 if (rec.ok())
+                                     ensure_eq(value(std::int64_t(count)), rec.result.at("id"));
+                                 else
+                                     ensure_eq(count + 1, rec.problems.at(0).line());
+                                 ++count;
+                             },
+                             threads
+                            );
+            ensure_eq(5000U, count);
+        }
+    }
+}
+
+TEST(ndjson_reader_threads_callback_throws)
+{
+    std::ostringstream src;
+    for (int idx = 0; idx < 5000; ++idx)
+        src << "[" << idx << "]\n";
+    std::string input = src.str();
+    ndjson_reader reader(input);
+    std::size_t count = 0;
+    ensure_throws(std::runtime_error,
+                  reader.read_all([&] (ndjson_reader::record&)
+                                  {
+                                      if (++count == 4000)
+                                          throw std::runtime_error("stop");
+                                  },
+                                  3
+                                 )
+                 );
+    ensure_eq(4000U, count);
+}
+
+TEST(ndjson_reader_collect_all)
+{
+    ndjson_reader reader(string_view("[1, 2,]\n[3]"),
+                         parse_options().failure_mode(parse_options::on_error::collect_all)
+                                        .comma_policy(parse_options::commas::strict)
+                        );
+    ndjson_reader::record rec;
+    ensure(reader.next(rec));
+    ensure(!rec.ok());
+    ensure_eq(array({ 1, 2 }), rec.result);
+    ensure(reader.next(rec));
+    ensure(rec.ok());
+    ensure_eq(array({ 3 }), rec.result);
+    ensure(!reader.next(rec));
+}
+
+TEST(ndjson_reader_stream_borrow_strings)
+{
+    // Each line from a stream is read into the same buffer, so strings must not be borrowed from it
+    std::string src = "\"the first line is a string which is too long to fit in a value\"\n"
+                      "[\"the second line has a long string which replaces the first\"]\n"
+                      "{\"third\": \"and the third line replaces the second one as well\"}\n";
+    std::istringstream stream(src);
+    ndjson_reader reader(stream, parse_options().borrow_strings(true));
+    std::vector<ndjson_reader::record> records;
+    ndjson_reader::record rec;
+    while (reader.next(rec))
+        records.push_back(rec);
+    
+    ndjson_reader expected_reader(src);
+    for (const ndjson_reader::record& got : records)
+    {
+        ensure(expected_reader.next(rec));
+        ensure(got.ok());
+        ensure_eq(rec.result, got.result);
+    }
+    ensure(!expected_reader.next(rec));
+}
+
+}
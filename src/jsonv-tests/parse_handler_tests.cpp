@@ -0,0 +1,201 @@
+/** \file
+ *
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include "filesystem_util.hpp"
+#include "test.hpp"
+
+#include <jsonv/array.hpp>
+#include <jsonv/mapped_file.hpp>
+#include <jsonv/object.hpp>
+#include <jsonv/parse.hpp>
+#include <jsonv/tokenizer.hpp>
+#include <jsonv/value.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace jsonv_test
+{
+
+using namespace jsonv;
+
+namespace
+{
+
+/** Builds a \c value from the events it receives, the slow and obvious way. **/
+class tree_handler :
+        public parse_handler
+{
+public:
+    value result;
+    
+    virtual void on_null() override                  { complete(null); }
+    virtual void on_boolean(bool x) override         { complete(x); }
+    virtual void on_integer(std::int64_t x) override { complete(x); }
+    virtual void on_decimal(double x) override       { complete(x); }
+    virtual void on_string(string_view x) override   { complete(std::string(x)); }
+    virtual void on_key(string_view x) override      { _keys.back() = std::string(x); }
+    
+    virtual void on_array_begin() override
+    {
+        _open.emplace_back(array());
+        _keys.emplace_back();
+    }
+    
+    virtual void on_object_begin() override
+    {
+        _open.emplace_back(object());
+        _keys.emplace_back();
+    }
+    
+    virtual void on_array_end() override  { close(); }
+    virtual void on_object_end() override { close(); }
+    
+private:
+    void complete(value x)
+    {
+        if (_open.empty())
+            result = std::move(x);
+        else if (_open.back().kind() == kind::array)
+            _open.back().push_back(std::move(x));
+        else
+            _open.back()[_keys.back()] = std::move(x);
+    }
+    
+    void close()
+    {
+        value x = std::move(_open.back());
+        _open.pop_back();
+        _keys.pop_back();
+        complete(std::move(x));
+    }
+    
+private:
+    std::vector<value>       _open;
+    std::vector<std::string> _keys;
+};
+
+/** Records the events it receives as text. **/
+class trace_handler :
+        public parse_handler
+{
+public:
+    std::ostringstream trace;
+    
+    virtual void on_null() override                  { trace << "null "; }
+    virtual void on_boolean(bool x) override         { trace << (x ? "true " : "false "); }
+    virtual void on_integer(std::int64_t x) override { trace << "i:" << x << ' '; }
+    virtual void on_decimal(double x) override       { trace << "d:" << x << ' '; }
+    virtual void on_string(string_view x) override   { trace << "s:" << x << ' '; }
+    virtual void on_key(string_view x) override      { trace << "k:" << x << ' '; }
+    virtual void on_array_begin() override           { trace << "[ "; }
+    virtual void on_array_end() override             { trace << "] "; }
+    virtual void on_object_begin() override          { trace << "{ "; }
+    virtual void on_object_end() override            { trace << "} "; }
+};
+
+}
+
+TEST(parse_handler_same_as_dom)
+{
+    for (const char* name : { "blns.json", "generated.json", "paths.json" })
+    {
+        mapped_file file(test_path(name));
+        tree_handler handler;
+        parse(file.contents(), handler);
+        ensure_eq(parse(file.contents()), handler.result);
+    }
+}
+
+TEST(parse_handler_events)
+{
+    trace_handler handler;
+    parse(R"({"a": [1, 2.5, "x\n"], "bc": {"d": null, "e": true}, "f": []})", handler);
+    ensure_eq(std::string("{ k:a [ i:1 d:2.5 s:x\n ] k:bc { k:d null k:e true } k:f [ ] } "), handler.trace.str());
+}
+
+TEST(parse_handler_default_ignores)
+{
+    struct object_counter :
+            parse_handler
+    {
+        std::size_t count = 0;
+        
+        virtual void on_object_begin() override { ++count; }
+    };
+    
+    object_counter counter;
+    parse(R"([{}, {"a": {"b": [{}]}}, 3, "x"])", counter);
+    ensure_eq(4U, counter.count);
+}
+
+TEST(parse_handler_stream)
+{
+    std::string src = R"([{"a": 1}, {"b": "two"}, [3, 4.5]])";
+    std::istringstream stream(src);
+    tokenizer tokens(stream);
+    tree_handler handler;
+    parse(tokens, handler);
+    ensure_eq(parse(src), handler.result);
+}
+
+TEST(parse_handler_errors_match_dom)
+{
+    auto options = parse_options()
+                   .failure_mode(parse_options::on_error::collect_all)
+                   .comma_policy(parse_options::commas::strict);
+    for (const char* src : { "[1, 2, bogus]", "[1,\n  2,\n  ]", "[1, [2, [3", "4", "{\"a\": {\"b\": [1" })
+    {
+        parse_error::problem_list dom_problems;
+        try
+        {
+            parse(src, parse_options(options).require_document(true));
+            ensure(false);
+        }
+        catch (const parse_error& err)
+        {
+            dom_problems = err.problems();
+        }
+        
+        trace_handler handler;
+        try
+        {
+            parse(src, handler, parse_options(options).require_document(true));
+            ensure(false);
+        }
+        catch (const parse_error& err)
+        {
+            ensure_eq(dom_problems.size(), err.problems().size());
+            for (std::size_t idx = 0; idx < dom_problems.size(); ++idx)
+            {
+                ensure_eq(dom_problems[idx].message(), err.problems()[idx].message());
+                ensure_eq(dom_problems[idx].character(), err.problems()[idx].character());
+            }
+            ensure(err.partial_result().is_null());
+        }
+    }
+}
+
+TEST(parse_handler_duplicate_keys)
+{
+    trace_handler handler;
+    parse(R"({"a": 1, "a": 2})", handler, parse_options::create_strict());
+    ensure_eq(std::string("{ k:a i:1 k:a i:2 } "), handler.trace.str());
+}
+
+TEST(parse_handler_unterminated)
+{
+    trace_handler handler;
+    ensure_throws(parse_error, parse("[1, {\"a\": [2", handler));
+    ensure_eq(std::string("[ i:1 { k:a [ i:2 "), handler.trace.str());
+}
+
+}
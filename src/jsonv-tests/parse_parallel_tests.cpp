@@ -0,0 +1,134 @@
+/** \file
+ *  
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include "filesystem_util.hpp"
+#include "test.hpp"
+
+#include <jsonv/array.hpp>
+#include <jsonv/mapped_file.hpp>
+#include <jsonv/object.hpp>
+#include <jsonv/parse.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+namespace jsonv_test
+{
+
+using namespace jsonv;
+
+static parse_error::problem_list problems_of(const std::string& src, const parse_options& options, bool parallel)
+{
+    try
+    {
+        if (parallel)
+            parse_parallel(src, options, 4);
+        else
+            parse(src, options);
+    }
+    catch (const parse_error& err)
+    {
+        return err.problems();
+    }
+    return {};
+}
+
+/** Get the differences between the problems \c parse and \c parse_parallel report for \a src. **/
+static std::string problem_differences(const std::string& src, const parse_options& options)
+{
+    parse_error::problem_list expected = problems_of(src, options, false);
+    parse_error::problem_list actual   = problems_of(src, options, true);
+    std::ostringstream        os;
+    if (expected.empty())
+        os << "parse found no problems in " << src;
+    for (std::size_t idx = 0; idx < std::max(expected.size(), actual.size()); ++idx)
+    {
+        if (idx >= expected.size())
+            os << "unexpected " << actual[idx] << '\n';
+        else if (idx >= actual.size())
+            os << "missing " << expected[idx] << '\n';
+        else if (to_string(expected[idx]) != to_string(actual[idx]))
+            os << "expected " << expected[idx] << " but found " << actual[idx] << '\n';
+    }
+    return os.str();
+}
+
+TEST(parse_parallel_same_as_parse)
+{
+    for (const char* name : { "blns.json", "generated.json", "paths.json" })
+    {
+        mapped_file file(test_path(name));
+        value expected = parse(file.contents());
+        for (std::size_t threads : { 0U, 1U, 2U, 3U, 16U })
+            ensure_eq(expected, parse_parallel(file.contents(), parse_options(), threads));
+    }
+}
+
+TEST(parse_parallel_small)
+{
+    ensure_eq(array(), parse_parallel("[]"));
+    ensure_eq(array({ 1 }), parse_parallel(" [ 1 ] "));
+    ensure_eq(array({ 1, "2", array({ 3 }), object({ { "4", null } }) }),
+              parse_parallel(R"([1, /* c */ "2", [3], {"4": null}])")
+             );
+    ensure_eq(value(5), parse_parallel("5"));
+    ensure_eq(array({ 1, 2 }),
+              parse_parallel("[1, 2,]", parse_options().comma_policy(parse_options::commas::allow_trailing))
+             );
+}
+
+TEST(parse_parallel_problems)
+{
+    auto strict = parse_options::create_strict();
+    auto collect = parse_options().failure_mode(parse_options::on_error::collect_all);
+    for (const char* src : { "[1, 2,]", "[1, [2", "[1] 2", "[01, 2]", "[1 2]", "[1, {\"a\" 1}, 3, {\"b\": [}]",
+                             "[\"x\",\n \"bad\\q\",\n [1, {\"a\":\n  tru}]]", "[[1, 2], [3,]]", "[1, 2, /* x */ 3]"
+                           }
+        )
+    {
+        ensure_eq(std::string(), problem_differences(src, strict));
+        auto collect_strict = parse_options(strict).failure_mode(parse_options::on_error::collect_all);
+        ensure_eq(std::string(), problem_differences(src, collect_strict));
+    }
+    
+    ensure_eq(std::string(), problem_differences("[1,\n {\"a\" 1},\n 3,\n {\"b\": 2, \"b\": 3},\n nul]", collect));
+    auto strict_commas = parse_options().comma_policy(parse_options::commas::strict);
+    ensure_eq(std::string(), problem_differences("[[1, 2], [3,]]", strict_commas));
+    ensure_eq(std::string(), problem_differences("[[[1]], 2]", parse_options().max_structure_depth(3)));
+    ensure_eq(array({ array({ 1 }), 2 }), parse_parallel("[[1], 2]", parse_options().max_structure_depth(3), 2));
+}
+
+TEST(parse_parallel_partial_result)
+{
+    auto partial_result_of = [] (const std::string& src, const parse_options& options, bool parallel) -> value
+                             {
+                                 try
+                                 {
+                                     return parallel ? parse_parallel(src, options, 4) : parse(src, options);
+                                 }
+                                 catch (const parse_error& err)
+                                 {
+                                     return err.partial_result();
+                                 }
+                             };
+    
+    for (const char* src : { "[1, [2 3], \"x\"]", "[1, 2,\n {\"a\": tru}, 4]", "[{\"a\": 1, \"a\": 2}, [1,, 2], 3]" })
+    {
+        auto collect = parse_options().failure_mode(parse_options::on_error::collect_all);
+        ensure_eq(partial_result_of(src, collect, false), partial_result_of(src, collect, true));
+        ensure_eq(std::string(), problem_differences(src, collect));
+        
+        auto ignore = parse_options().failure_mode(parse_options::on_error::ignore);
+        ensure_eq(parse(src, ignore), parse_parallel(src, ignore, 4));
+    }
+}
+
+}
@@ -15,6 +15,7 @@
 #include <jsonv/object.hpp>
 #include <jsonv/tokenizer.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 using namespace jsonv;
@@ -253,6 +254,79 @@ TEST_PARSE(partial_array)
     }
 }
 
+TEST_PARSE(partial_nested_array)
+{
+    try
+    {
+        parse("[1, [2, [3, 4], 5], [6, 7", parse_options().failure_mode(parse_options::on_error::collect_all));
+        ensure(false);
+    }
+    catch (const jsonv::parse_error& err)
+    {
+        value expected = array({ 1, array({ 2, array({ 3, 4 }), 5 }) });
+        ensure_eq(expected, err.partial_result());
+    }
+}
+
+TEST_PARSE(problem_position)
+{
+    auto options = parse_options()
+                   .comma_policy(parse_options::commas::strict);
+    try
+    {
+        parse("[1,\n  2,\n  ]", options);
+        ensure(false);
+    }
+    catch (const jsonv::parse_error& err)
+    {
+        const parse_error::problem& p = err.problems().at(0);
+        ensure_eq(3U,  p.line());
+        ensure_eq(3U,  p.column());
+        ensure_eq(11U, p.character());
+    }
+}
+
+TEST_PARSE(problem_position_at_end)
+{
+    try
+    {
+        parse("[1,\n  2 ");
+        ensure(false);
+    }
+    catch (const jsonv::parse_error& err)
+    {
+        const parse_error::problem& p = err.problems().at(0);
+        ensure_eq(2U, p.line());
+        ensure_eq(5U, p.column());
+        ensure_eq(8U, p.character());
+    }
+}
+
+TEST_PARSE(problem_message_names_key)
+{
+    auto options = parse_options()
+                   .failure_mode(parse_options::on_error::collect_all);
+    try
+    {
+        parse(R"({"a": 1, "b": {"c": [1)", options);
+        ensure(false);
+    }
+    catch (const jsonv::parse_error& err)
+    {
+        auto reported = [&] (const std::string& message)
+                        {
+                            return std::any_of(err.problems().begin(), err.problems().end(),
+                                               [&] (const parse_error::problem& p)
+                                               {
+                                                   return p.message().find(message) == 0;
+                                               }
+                                              );
+                        };
+        ensure(reported("Unexpected end: incomplete value for key 'c'"));
+        ensure(reported("Unexpected end: incomplete value for key 'b'"));
+    }
+}
+
 TEST_PARSE(depth)
 {
     std::string src = R"({"a": null, "b": [{}, 3, 4.5, false, [[[[[[[[[[[[[[[[[[[[[]]]]]]]]]]]]]]]]]]]]]]})";
@@ -261,6 +335,36 @@ TEST_PARSE(depth)
     ensure_throws(parse_error, parse(src, parse_options::create_strict()));
 }
 
+TEST_PARSE(depth_collect_all)
+{
+    auto options = parse_options()
+                   .failure_mode(parse_options::on_error::collect_all)
+                   .max_structure_depth(3);
+    try
+    {
+        parse(R"([1, [2, [3, [4]], {"a": {"b": 5}}], 6])", options);
+        ensure(false);
+    }
+    catch (const parse_error& err)
+    {
+        ensure_eq(2U, err.problems().size());
+        value expected = array({ 1, array({ 2, array(), object() }), 6 });
+        ensure_eq(expected, err.partial_result());
+    }
+}
+
+TEST_PARSE(depth_hostile)
+{
+    // Enough nesting that a parser which recursed all the way down would run out of stack
+    std::string src = std::string(1000000, '[') + std::string(1000000, ']');
+    ensure_throws(parse_error, parse(src, parse_options::create_strict()));
+    
+    auto options = parse_options()
+                   .failure_mode(parse_options::on_error::collect_all)
+                   .max_structure_depth(64);
+    ensure_throws(parse_error, parse(src, options));
+}
+
 TEST_PARSE(literal)
 {
     value v = "[1, 2, 3, 4]"_json;
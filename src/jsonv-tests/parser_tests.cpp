@@ -0,0 +1,115 @@
+/** \file
+ *  
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include "filesystem_util.hpp"
+#include "test.hpp"
+
+#include <jsonv/arena.hpp>
+#include <jsonv/array.hpp>
+#include <jsonv/mapped_file.hpp>
+#include <jsonv/object.hpp>
+#include <jsonv/parse.hpp>
+
+#include <string>
+#include <utility>
+
+namespace jsonv_test
+{
+
+using namespace jsonv;
+
+/** Get the text of the first problem \c parse or a \c parser finds in \a src, or an empty string if there are none. **/
+template <typename FParse>
+static std::string first_problem(FParse&& parse_it, const std::string& src)
+{
+    try
+    {
+        parse_it(src);
+        return std::string();
+    }
+    catch (const parse_error& err)
+    {
+        return to_string(err.problems().at(0));
+    }
+}
+
+TEST(parser_same_as_parse)
+{
+    parser p;
+    for (const char* name : { "blns.json", "generated.json", "paths.json", "generated.json" })
+    {
+        mapped_file file(test_path(name));
+        ensure_eq(parse(file.contents()), p.parse(file.contents()));
+    }
+}
+
+TEST(parser_reuse_after_problems)
+{
+    for (auto options : { parse_options(),
+                          parse_options::create_strict(),
+                          parse_options().failure_mode(parse_options::on_error::collect_all),
+                        }
+        )
+    {
+        parser p(options);
+        for (const char* src : { "[1, 2, 3]", "[1, [2, {\"a\": ", "{\"a\": [1, 2]}", "[1, 2,]", "{\"a\" 1}", "[01]",
+                                 "{\"b\": \"\\q\"}", "", "[[[]]]", "{\"a\": 1, \"a\": 2}", "4", "[true] x", "[nul]"
+                               }
+            )
+        {
+            std::string expected = first_problem([&] (const std::string& s) { return parse(s, options); }, src);
+            std::string actual   = first_problem([&] (const std::string& s) { return p.parse(s); }, src);
+            ensure_eq(expected, actual);
+            if (expected.empty())
+                ensure_eq(parse(src, options), p.parse(src));
+        }
+    }
+}
+
+TEST(parser_partial_result)
+{
+    parser p(parse_options().failure_mode(parse_options::on_error::collect_all));
+    try
+    {
+        p.parse("[1, 2, [3, 4");
+        ensure(false);
+    }
+    catch (const parse_error& err)
+    {
+        ensure_eq(array({ 1, 2 }), err.partial_result());
+    }
+    ensure_eq(array({ 5 }), p.parse("[5]"));
+}
+
+TEST(parser_arena)
+{
+    parser p;
+    std::string src = R"({"a": [1, "two", {"three": 3.5}], "b": "a long enough string to go to the arena"})";
+    for (int pass = 0; pass < 3; ++pass)
+    {
+        arena region;
+        ensure_eq(parse(src), p.parse(src, region));
+        ensure_eq(parse(src), p.parse(src));
+    }
+}
+
+TEST(parser_options_and_move)
+{
+    parser p(parse_options().comments(false));
+    ensure(!p.options().comments());
+    ensure_throws(parse_error, p.parse(R"([{"a": 1}, /* comment */ {"a": 2}])"));
+    
+    parser q(std::move(p));
+    ensure(!q.options().comments());
+    ensure_eq(object({ { "a", 3 } }), q.parse(R"({"a": 3})"));
+    ensure_throws(parse_error, q.parse("/* comment */ {}"));
+}
+
+}
@@ -0,0 +1,187 @@
+/** \file
+ *  
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include "filesystem_util.hpp"
+#include "test.hpp"
+
+#include <jsonv/array.hpp>
+#include <jsonv/mapped_file.hpp>
+#include <jsonv/object.hpp>
+#include <jsonv/parse.hpp>
+#include <jsonv/reader.hpp>
+#include <jsonv/tokenizer.hpp>
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace jsonv_test
+{
+
+using namespace jsonv;
+
+using event = reader::event;
+
+static std::string all_events(reader& in)
+{
+    std::ostringstream os;
+    for (event e = in.next_event(); e != event::end; e = in.next_event())
+    {
+        os << e;
+        if (e == event::key || e == event::string)
+            os << ':' << in.as_string();
+        else if (e == event::integer)
+            os << ':' << in.as_integer();
+        os << ' ';
+    }
+    return os.str();
+}
+
+TEST(reader_events)
+{
+    reader in(string_view(R"({"a": [1, 2.5, "x\ty"], "b": {"c": null, "d": true}, "e": []})"));
+    ensure_eq(std::string("object_begin key:a array_begin integer:1 decimal string:x\ty array_end "
+                          "key:b object_begin key:c null key:d boolean object_end key:e array_begin array_end "
+                          "object_end "
+                         ),
+              all_events(in)
+             );
+    ensure(in.current_event() == event::end);
+    ensure(in.next_event() == event::end);
+}
+
+TEST(reader_scalar_root)
+{
+    reader in(string_view("  -4  "));
+    ensure(in.next_event() == event::integer);
+    ensure_eq(-4, in.as_integer());
+    ensure_eq(-4.0, in.as_decimal());
+    ensure_throws(std::logic_error, in.as_string());
+    ensure(in.next_event() == event::end);
+}
+
+TEST(reader_skip_and_read)
+{
+    std::string src = R"([{"junk": {"x": ["]", "}\"", [[]]]}, "id": 1, "more": [1, 2, {"a": "b"}]},)"
+                      R"( {"junk": "string", "id": {"nested": true}, "more": null}])";
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        std::istringstream stream(src);
+        tokenizer tokens(stream);
+        std::unique_ptr<reader> in(pass == 0 ? new reader(src) : new reader(tokens));
+        
+        std::vector<value> ids;
+        ensure(in->next_event() == event::array_begin);
+        while (in->next_event() == event::object_begin)
+        {
+            while (in->next_event() == event::key)
+            {
+                if (in->as_string() == "id")
+                    ids.push_back(in->read_value());
+                else
+                    in->skip_value();
+            }
+            ensure(in->current_event() == event::object_end);
+        }
+        ensure(in->current_event() == event::array_end);
+        ensure(in->next_event() == event::end);
+        ensure_eq(2U, ids.size());
+        ensure_eq(value(1), ids[0]);
+        ensure_eq(object({ { "nested", true } }), ids[1]);
+    }
+}
+
+TEST(reader_skip_after_begin)
+{
+    reader in(string_view(R"([[1, [2]], {"a": {}}, 3])"));
+    ensure(in.next_event() == event::array_begin);
+    ensure(in.next_event() == event::array_begin);
+    ensure_eq(2U, in.depth());
+    in.skip_value();
+    ensure(in.current_event() == event::array_end);
+    ensure_eq(1U, in.depth());
+    ensure(in.next_event() == event::object_begin);
+    ensure_eq(object({ { "a", object() } }), in.read_value());
+    ensure(in.next_event() == event::integer);
+    ensure_eq(value(3), in.read_value());
+    ensure(in.next_event() == event::array_end);
+    ensure(in.next_event() == event::end);
+    ensure_throws(std::logic_error, in.skip_value());
+}
+
+TEST(reader_read_value_same_as_parse)
+{
+    for (const char* name : { "blns.json", "generated.json", "paths.json" })
+    {
+        mapped_file file(test_path(name));
+        reader in(file.contents());
+        in.next_event();
+        ensure_eq(parse(file.contents()), in.read_value());
+        ensure(in.next_event() == event::end);
+    }
+}
+
+TEST(reader_skip_everything)
+{
+    mapped_file file(test_path("generated.json"));
+    reader in(file.contents());
+    in.next_event();
+    in.skip_value();
+    ensure_eq(0U, in.depth());
+    ensure(in.next_event() == event::end);
+}
+
+TEST(reader_problems)
+{
+    auto strict = parse_options::create_strict();
+    for (const char* src : { "[1, 2,]", R"({"a" 1})", R"({"a": 1 "b": 2})", "[1, [2", "[1] 2", "[01]",
+                             R"([1, {"a": [2)"
+                           }
+        )
+    {
+        reader in(string_view(src), strict);
+        try
+        {
+            while (true)
+            {
+                event e = in.next_event();
+                if (e == event::end)
+                    break;
+                else if (e == event::key)
+                    in.skip_value();
+            }
+            ensure(false);
+        }
+        catch (const parse_error& err)
+        {
+            ensure_eq(1U, err.problems().size());
+        }
+    }
+}
+
+TEST(reader_problem_position)
+{
+    reader in(string_view("[1,\n  2,\n  ]"), parse_options().comma_policy(parse_options::commas::strict));
+    try
+    {
+        all_events(in);
+        ensure(false);
+    }
+    catch (const parse_error& err)
+    {
+        const parse_error::problem& p = err.problems().at(0);
+        ensure_eq(3U,  p.line());
+        ensure_eq(3U,  p.column());
+        ensure_eq(11U, p.character());
+    }
+}
+
+}
@@ -106,3 +106,111 @@ TEST(string_view_construction)
 
     ensure_eq(cp, sv);
 }
+
+TEST(string_short_and_long)
+{
+    using namespace jsonv;
+    
+    const std::string short_str(14, 'a');
+    const std::string long_str(15, 'a');
+    
+    value short_val = short_str;
+    value long_val  = long_str;
+    ensure_eq(short_str, short_val.as_string());
+    ensure(short_val.as_string_view() == short_str);
+    ensure_eq(14U, short_val.size());
+    ensure_eq(long_str, long_val.as_string());
+    ensure_eq(15U, long_val.size());
+    ensure_lt(short_val, long_val);
+    ensure_eq(short_val, value(std::string(short_str)));
+    ensure_eq(long_val, value(std::string(long_str)));
+    ensure_eq(std::hash<value>()(short_val), std::hash<value>()(value(short_str)));
+}
+
+TEST(string_short_copy_move_swap)
+{
+    using namespace jsonv;
+    
+    value a = "short";
+    value b = "long enough to not be inline";
+    
+    value a_copy = a;
+    ensure_eq(a, a_copy);
+    
+    swap(a, b);
+    ensure_eq("long enough to not be inline", a.as_string());
+    ensure_eq("short", b.as_string());
+    
+    value moved = std::move(b);
+    ensure_eq("short", moved.as_string());
+    ensure(b.is_null());
+    
+    moved = a;
+    ensure_eq(a, moved);
+    moved = "x";
+    ensure_eq("x", moved.as_string());
+    moved.clear();
+    ensure(moved.is_null());
+}
+
+TEST(string_short_in_containers)
+{
+    using namespace jsonv;
+    
+    value arr = array();
+    for (int idx = 0; idx < 100; ++idx)
+        arr.push_back(std::to_string(idx));
+    for (int idx = 0; idx < 100; ++idx)
+        ensure_eq(std::to_string(idx), arr[idx].as_string());
+    
+    value obj = parse(R"({"status": "active", "email": "someone@mail.example.com", "empty": ""})");
+    ensure_eq("active", obj.at("status").as_string());
+    ensure_eq("someone@mail.example.com", obj.at("email").as_string());
+    ensure(obj.at("empty").empty());
+    ensure_eq(obj, parse(to_string(obj)));
+}
+
+TEST(string_borrowed)
+{
+    using namespace jsonv;
+    
+    std::string source = "this string is long enough to be borrowed";
+    value borrowed = borrowed_string(source);
+    ensure(borrowed.as_string_view().data() == source.data());
+    ensure_eq(value(source), borrowed);
+    
+    value copy = borrowed;
+    ensure(copy.as_string_view().data() == source.data());
+    
+    // as_string makes a copy without changing the value
+    ensure_eq(source, copy.as_string());
+    ensure(copy.as_string_view().data() == source.data());
+    ensure_eq(borrowed, copy);
+    
+    value owned = value(borrowed.as_string_view());
+    ensure(owned.as_string_view().data() != source.data());
+    
+    // short strings are stored inline instead
+    std::string short_source = "short";
+    ensure(borrowed_string(short_source).as_string_view().data() != short_source.data());
+    
+    borrowed.clear();
+    ensure(borrowed.is_null());
+}
+
+TEST(string_as_string_does_not_modify)
+{
+    using namespace jsonv;
+    
+    std::string long_source = "this string is long enough to be borrowed";
+    for (value val : { value("short"), value(long_source), borrowed_string(long_source) })
+    {
+        std::size_t hash_before = std::hash<value>()(val);
+        const value& cval = val;
+        const char* data_before = cval.as_string_view().data();
+        std::string copy = cval.as_string();
+        ensure_eq(std::string(cval.as_string_view()), copy);
+        ensure(data_before == cval.as_string_view().data());
+        ensure_eq(hash_before, std::hash<value>()(val));
+    }
+}
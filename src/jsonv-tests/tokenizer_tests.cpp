@@ -10,10 +10,14 @@
 **/
 #include "test.hpp"
 
+#include <jsonv/parse.hpp>
 #include <jsonv/tokenizer.hpp>
 
+#include <memory>
 #include <random>
 #include <sstream>
+#include <utility>
+#include <vector>
 
 namespace jsonv_test
 {
@@ -62,4 +66,187 @@ TEST(tokenizer_string)
     ensure_eq(found.text, "\"true\"");
 }
 
+/** Sets the \c tokenizer::min_buffer_size for the duration of a test. **/
+class scoped_min_buffer_size
+{
+public:
+    explicit scoped_min_buffer_size(tokenizer::size_type sz) :
+            _original(tokenizer::min_buffer_size())
+    {
+        tokenizer::set_min_buffer_size(sz);
+    }
+    
+    ~scoped_min_buffer_size()
+    {
+        tokenizer::set_min_buffer_size(_original);
+    }
+    
+private:
+    tokenizer::size_type _original;
+};
+
+static std::vector<std::pair<std::string, token_kind>> all_tokens(tokenizer& tokens)
+{
+    std::vector<std::pair<std::string, token_kind>> out;
+    while (tokens.next())
+        out.emplace_back(std::string(tokens.current().text), tokens.current().kind);
+    return out;
+}
+
+TEST(tokenizer_stream_straddles_buffer)
+{
+    // every token in here is split across buffers for some buffer size
+    std::string input = R"({"key": [true, false, null, -12.5e+3, "esc\"aped\\", "unicode \u00e9"] /* comment */,)"
+                        "\n\t  \"x\": 1234567890, \"y\": tru }";
+    tokenizer from_view(input);
+    auto expected = all_tokens(from_view);
+    
+    for (tokenizer::size_type buffer_size = 1; buffer_size < 20; ++buffer_size)
+    {
+        scoped_min_buffer_size scoped_size(buffer_size);
+        std::istringstream istream(input);
+        tokenizer from_stream(istream);
+        ensure_eq(expected.size(), all_tokens(from_stream).size());
+        
+        std::istringstream istream2(input);
+        tokenizer from_stream2(istream2);
+        ensure(expected == all_tokens(from_stream2));
+    }
+}
+
+TEST(tokenizer_stream_bounded_buffer)
+{
+    scoped_min_buffer_size scoped_size(64);
+    
+    std::ostringstream source;
+    source << '[';
+    for (int idx = 0; idx < 10000; ++idx)
+        source << (idx ? "," : "") << "{\"index\": " << idx << ", \"name\": \"entry number " << idx << "\"}";
+    source << ']';
+    
+    std::string input = source.str();
+    tokenizer from_view(input);
+    std::istringstream istream(input);
+    tokenizer from_stream(istream);
+    while (from_view.next())
+    {
+        ensure(from_stream.next());
+        ensure_eq(from_view.current().text, from_stream.current().text);
+        ensure(from_stream.input().size() <= 64);
+    }
+    ensure(!from_stream.next());
+}
+
+TEST(tokenizer_stream_large_token)
+{
+    scoped_min_buffer_size scoped_size(16);
+    
+    std::string big(100000, 'x');
+    std::istringstream istream("[\"" + big + "\", 1]");
+    tokenizer tokens(istream);
+    value parsed = parse(tokens);
+    ensure_eq(big, parsed.at(0).as_string());
+    ensure_eq(1, parsed.at(1).as_integer());
+}
+
+TEST(tokenizer_stream_problem_position)
+{
+    scoped_min_buffer_size scoped_size(4);
+    
+    std::string input = "[1,\n  2,\n  3,\n  4,\n  ]";
+    auto options = parse_options()
+                   .comma_policy(parse_options::commas::strict);
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        std::istringstream istream(input);
+        try
+        {
+            if (pass == 0)
+                parse(input, options);
+            else
+                parse(istream, options);
+            ensure(false);
+        }
+        catch (const parse_error& err)
+        {
+            const parse_error::problem& p = err.problems().at(0);
+            ensure_eq(5U,  p.line());
+            ensure_eq(3U,  p.column());
+            ensure_eq(21U, p.character());
+        }
+    }
+}
+
+TEST(tokenizer_skip_structure)
+{
+    std::string input = R"([{"a": "]}\"[{", "b": [1, {"c": []}]} /* ] } */, ["{"]], "after")";
+    // a buffer_size of 0 means reading from a string_view
+    for (tokenizer::size_type buffer_size : std::vector<tokenizer::size_type>({ 0, 1, 7 }))
+    {
+        scoped_min_buffer_size scoped_size(buffer_size == 0 ? tokenizer::min_buffer_size() : buffer_size);
+        std::istringstream istream(input);
+        std::unique_ptr<tokenizer> tokens(buffer_size == 0 ? new tokenizer(input) : new tokenizer(istream));
+        
+        ensure(tokens->next());
+        ensure(tokens->skip_structure());
+        ensure(tokens->current().kind == token_kind::array_end);
+        ensure(tokens->next());
+        ensure_eq(string_view(","), tokens->current().text);
+        ensure(tokens->next());
+        ensure(tokens->next());
+        ensure_eq(string_view("\"after\""), tokens->current().text);
+        ensure(!tokens->next());
+    }
+}
+
+TEST(tokenizer_skip_structure_unterminated)
+{
+    tokenizer tokens(string_view(R"({"a": [1, 2})"));
+    ensure(tokens.next());
+    ensure(!tokens.skip_structure());
+    ensure(!tokens.next());
+    
+    tokenizer not_structure(string_view("1"));
+    ensure(not_structure.next());
+    ensure_throws(std::logic_error, not_structure.skip_structure());
+}
+
+TEST(tokenizer_reset)
+{
+    std::istringstream stream("[1, \n2]");
+    tokenizer tokens(stream);
+    while (tokens.next())
+    { }
+    
+    tokens.reset(string_view("\n\ntrue"));
+    ensure_throws(std::logic_error, tokens.current());
+    ensure(tokens.next());
+    ensure(tokens.next());
+    ensure(tokens.current().kind == token_kind::boolean);
+    tokenizer::size_type line, column, character;
+    tokens.locate(tokens.current().text.data(), line, column, character);
+    ensure_eq(3U, line);
+    ensure_eq(1U, column);
+    ensure_eq(2U, character);
+    ensure(!tokens.next());
+}
+
+TEST(tokenizer_stream_borrow_strings_ignored)
+{
+    // Reading from a stream drops and moves the buffer, so strings must be copied out of it
+    scoped_min_buffer_size scoped_size(16);
+    std::string src = R"({"first": "a string which is too long to fit in a value", "rest": ["another long string )"
+                      R"(which is read after a refill", "and a third string which should be copied as well"]})";
+    std::istringstream stream(src);
+    tokenizer tokens(stream);
+    ensure(!tokens.input_is_stable());
+    ensure(tokenizer(string_view(src)).input_is_stable());
+    
+    value parsed = parse(tokens, parse_options().borrow_strings(true));
+    ensure_eq(parse(src), parsed);
+    
+    std::istringstream other_stream(src);
+    ensure_eq(parse(src), parse(other_stream, parse_options().borrow_strings(true)));
+}
+
 }
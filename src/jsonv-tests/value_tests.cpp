@@ -13,6 +13,7 @@
 #include <jsonv/all.hpp>
 
 #include <cstdint>
+#include <stdexcept>
 #include <tuple>
 #include <unordered_map>
 #include <unordered_set>
@@ -145,3 +146,129 @@ TEST(hash_set_operations)
     ensure_eq(0U, set.count(str));
     ensure_eq(5U, set.size());
 }
+
+TEST(sharing_copy_shares_nodes)
+{
+    jsonv::value orig = jsonv::parse(R"({"a": [1, 2, {"b": "a string long enough to need its own buffer"}], "c": {}})");
+    orig.enable_sharing();
+    
+    const jsonv::value copy = orig;
+    const jsonv::value& corig = orig;
+    ensure_eq(corig, copy);
+    ensure(&corig.at("a") == &copy.at("a"));
+    ensure(&corig.at("a").at(2).at("b") == &copy.at("a").at(2).at("b"));
+}
+
+TEST(sharing_copy_on_write)
+{
+    jsonv::value orig = jsonv::parse(R"({"a": [1, 2, {"b": "x"}], "c": {"d": null}})");
+    orig.enable_sharing();
+    const jsonv::value expected = jsonv::parse(R"({"a": [1, 2, {"b": "x"}], "c": {"d": null}})");
+    
+    jsonv::value copy = orig;
+    copy["a"][2]["b"] = "y";
+    copy["a"].push_back(3);
+    copy.erase("c");
+    ensure_eq(expected, orig);
+    ensure_eq(jsonv::parse(R"({"a": [1, 2, {"b": "y"}, 3]})"), copy);
+    
+    // the untouched parts are still shared
+    jsonv::value other = orig;
+    other["a"].pop_back();
+    const jsonv::value& corig  = orig;
+    const jsonv::value& cother = other;
+    ensure(&corig.at("c").at("d") == &cother.at("c").at("d"));
+    ensure(&corig.at("a").at(0) != &cother.at("a").at(0));
+    ensure_eq(expected, orig);
+}
+
+TEST(sharing_erase_with_iterators_from_shared)
+{
+    jsonv::value orig = jsonv::object({ { "a", 1 }, { "b", 2 }, { "c", 3 }, { "d", 4 } });
+    orig.enable_sharing();
+    jsonv::value copy = orig;
+    
+    const jsonv::value& ccopy = copy;
+    auto first = ccopy.find("b");
+    auto last  = ccopy.find("d");
+    copy.erase(first, last);
+    ensure_eq(jsonv::object({ { "a", 1 }, { "d", 4 } }), copy);
+    ensure_eq(4U, orig.size());
+    
+    jsonv::value copy2 = orig;
+    const jsonv::value& ccopy2 = copy2;
+    copy2.erase(ccopy2.find("a"));
+    ensure_eq(jsonv::object({ { "b", 2 }, { "c", 3 }, { "d", 4 } }), copy2);
+    ensure_eq(4U, orig.size());
+}
+
+TEST(sharing_references_stable_after_copy)
+{
+    jsonv::value orig = jsonv::parse(R"({"a": 1, "c": {"d": null}, "e": [1, 2, 3]})");
+    orig.enable_sharing();
+    const jsonv::value expected = orig;
+    
+    jsonv::value& a = orig["a"];
+    jsonv::value& d = orig.at("c").at("d");
+    jsonv::value copy = orig;
+    a = 2;
+    d = "changed";
+    ensure_eq(expected, copy);
+    ensure_eq(jsonv::parse(R"({"a": 2, "c": {"d": "changed"}, "e": [1, 2, 3]})"), orig);
+    
+    // children which were not accessed through a reference are still shared
+    const jsonv::value& corig = orig;
+    const jsonv::value& ccopy = copy;
+    ensure(&corig.at("e").at(0) == &ccopy.at("e").at(0));
+}
+
+TEST(sharing_iterators_stable_after_copy)
+{
+    jsonv::value orig = jsonv::object({ { "a", 1 }, { "b", 2 }, { "c", jsonv::array({ 1, 2 }) } });
+    orig.enable_sharing();
+    const jsonv::value expected = orig;
+    
+    auto obj_iter = orig.find("b");
+    auto arr_iter = orig.at("c").begin_array();
+    jsonv::value copy = orig;
+    obj_iter->second = 20;
+    *arr_iter = 10;
+    orig.erase(obj_iter);
+    ensure_eq(expected, copy);
+    ensure_eq(jsonv::object({ { "a", 1 }, { "c", jsonv::array({ 10, 2 }) } }), orig);
+    
+    auto end_iter = orig.end_object();
+    jsonv::value copy2 = orig;
+    ensure(orig.find("z") == end_iter);
+    orig.insert(end_iter, { "z", 26 });
+    ensure_eq(2U, copy2.size());
+    ensure_eq(3U, orig.size());
+}
+
+TEST(sharing_failed_lookup_does_not_copy)
+{
+    jsonv::value orig = jsonv::parse(R"({"a": [1, 2], "b": {"c": 3}})");
+    orig.enable_sharing();
+    jsonv::value copy = orig;
+    ensure_throws(std::out_of_range, orig.at("missing"));
+    ensure_eq(0U, orig.erase("missing"));
+    const jsonv::value& corig = orig;
+    const jsonv::value& ccopy = copy;
+    ensure(&corig.at("a") == &ccopy.at("a"));
+    
+    jsonv::value arr = jsonv::array({ 1, 2 });
+    arr.enable_sharing();
+    jsonv::value arr_copy = arr;
+    ensure_throws(std::out_of_range, arr.at(2));
+    const jsonv::value& carr      = arr;
+    const jsonv::value& carr_copy = arr_copy;
+    ensure(&carr.at(0) == &carr_copy.at(0));
+}
+
+TEST(sharing_not_enabled_copies)
+{
+    jsonv::value orig = jsonv::array({ jsonv::object({ { "a", 1 } }) });
+    const jsonv::value copy = orig;
+    const jsonv::value& corig = orig;
+    ensure(&corig.at(0) != &copy.at(0));
+}
@@ -25,7 +25,7 @@ struct compare_traits_icase :
         public compare_traits
 {
     /** Compares strings a and b in a case-insensitive manner. It is not UTF-8 aware and I am not sure it needs to be. **/
-    static int compare_strings(const std::string& a, const std::string& b)
+    static int compare_strings(string_view a, string_view b)
     {
         using std::begin;
         using std::end;
@@ -118,7 +118,7 @@ value merge_explicit(const merge_rules& rules,
         case kind::null:
             return a;
         case kind::string:
-            return a.as_string() + b.as_string();
+            return std::string(a.as_string_view()) + std::string(b.as_string_view());
         default:
             throw kind_error(std::string("Invalid kind ") + to_string(a.kind()));
     }
@@ -0,0 +1,100 @@
+/** \file
+ *
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv/arena.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+namespace jsonv
+{
+
+/** Blocks are kept in a singly-linked list. The usable memory follows the header. **/
+struct arena::block
+{
+    block*    next;
+    size_type size;
+};
+
+static const arena::size_type max_block_size = 4 * 1024 * 1024;
+
+static char* align_up(char* ptr, arena::size_type alignment)
+{
+    auto address = reinterpret_cast<std::uintptr_t>(ptr);
+    auto aligned = (address + alignment - 1) & ~std::uintptr_t(alignment - 1);
+    return ptr + (aligned - address);
+}
+
+arena::arena(size_type initial_block_size) :
+        _blocks(nullptr),
+        _cursor(nullptr),
+        _limit(nullptr),
+        _next_block_size(std::max(initial_block_size, size_type(256))),
+        _allocated(0),
+        _reserved(0)
+{ }
+
+arena::~arena() noexcept
+{
+    release();
+}
+
+void* arena::allocate(size_type size, size_type alignment)
+{
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+        throw std::invalid_argument("arena alignment must be a power of 2");
+
+    char* out = _cursor ? align_up(_cursor, alignment) : nullptr;
+    if (!out || out + size > _limit)
+    {
+        size_type block_size = std::max(_next_block_size, sizeof(block) + size + alignment);
+        auto      new_block  = static_cast<block*>(::operator new(block_size));
+        new_block->next = _blocks;
+        new_block->size = block_size;
+        _blocks    = new_block;
+        _reserved += block_size;
+        _cursor    = reinterpret_cast<char*>(new_block) + sizeof(block);
+        _limit     = reinterpret_cast<char*>(new_block) + block_size;
+        _next_block_size = std::min(_next_block_size * 2, max_block_size);
+
+        out = align_up(_cursor, alignment);
+    }
+
+    _cursor     = out + size;
+    _allocated += size;
+    return out;
+}
+
+void arena::release() noexcept
+{
+    while (_blocks)
+    {
+        block* next = _blocks->next;
+        ::operator delete(_blocks);
+        _blocks = next;
+    }
+    _cursor    = nullptr;
+    _limit     = nullptr;
+    _allocated = 0;
+    _reserved  = 0;
+}
+
+arena::size_type arena::bytes_allocated() const
+{
+    return _allocated;
+}
+
+arena::size_type arena::bytes_reserved() const
+{
+    return _reserved;
+}
+
+}
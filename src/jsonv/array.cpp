@@ -14,6 +14,8 @@
 
 #include <algorithm>
 #include <ostream>
+#include <stdexcept>
+#include <string>
 
 namespace jsonv
 {
@@ -21,8 +23,16 @@ namespace jsonv
 value array()
 {
     value x;
-    x._data.array = new detail::array_impl;
-    x._kind = jsonv::kind::array;
+    x._fields.data.array = detail::array_impl::create(nullptr);
+    x._fields.kind = jsonv::kind::array;
+    return x;
+}
+
+value array(arena& region)
+{
+    value x;
+    x._fields.data.array = detail::array_impl::create(&region);
+    x._fields.kind = jsonv::kind::array;
     return x;
 }
 
@@ -63,13 +73,13 @@ value::const_array_iterator value::begin_array() const
 value::array_iterator value::end_array()
 {
     check_type(jsonv::kind::array, kind());
-    return array_iterator(this, _data.array->_values.size());
+    return array_iterator(this, _fields.data.array->_values.size());
 }
 
 value::const_array_iterator value::end_array() const
 {
     check_type(jsonv::kind::array, kind());
-    return const_array_iterator(this, _data.array->_values.size());
+    return const_array_iterator(this, _fields.data.array->_values.size());
 }
 
 value::array_view value::as_array() &
@@ -94,86 +104,101 @@ value::owning_array_view value::as_array() &&
 value& value::operator[](size_type idx)
 {
     check_type(jsonv::kind::array, kind());
-    return _data.array->_values[idx];
+    return detail::expose(_fields.data.array)->_values[idx];
 }
 
 const value& value::operator[](size_type idx) const
 {
     check_type(jsonv::kind::array, kind());
-    return _data.array->_values[idx];
+    return _fields.data.array->_values[idx];
 }
 
 value& value::at(size_type idx)
 {
     check_type(jsonv::kind::array, kind());
-    return _data.array->_values.at(idx);
+    // check the index first, so a failed lookup does not copy a shared array
+    if (idx >= _fields.data.array->_values.size())
+        throw std::out_of_range("Index " + std::to_string(idx) + " is out of range for array of size "
+                                + std::to_string(_fields.data.array->_values.size())
+                               );
+    return detail::expose(_fields.data.array)->_values[idx];
 }
 
 const value& value::at(size_type idx) const
 {
     check_type(jsonv::kind::array, kind());
-    return _data.array->_values.at(idx);
+    return _fields.data.array->_values.at(idx);
 }
 
 void value::push_back(value item)
 {
     check_type(jsonv::kind::array, kind());
-    _data.array->_values.emplace_back(std::move(item));
+    detail::unshare(_fields.data.array)->_values.emplace_back(std::move(item));
 }
 
 void value::pop_back()
 {
     check_type(jsonv::kind::array, kind());
-    if (_data.array->_values.empty())
+    if (_fields.data.array->_values.empty())
         throw std::logic_error("Cannot pop from empty array");
-    _data.array->_values.pop_back();
+    detail::unshare(_fields.data.array)->_values.pop_back();
 }
 
 void value::push_front(value item)
 {
     check_type(jsonv::kind::array, kind());
-    _data.array->_values.emplace_front(std::move(item));
+    auto& values = detail::unshare(_fields.data.array)->_values;
+    values.insert(values.begin(), std::move(item));
 }
 
 void value::pop_front()
 {
     check_type(jsonv::kind::array, kind());
-    if (_data.array->_values.empty())
+    if (_fields.data.array->_values.empty())
         throw std::logic_error("Cannot pop from empty array");
-    _data.array->_values.pop_front();
+    auto& values = detail::unshare(_fields.data.array)->_values;
+    values.erase(values.begin());
 }
 
 value::array_iterator value::insert(const_array_iterator position, value item)
 {
     check_type(jsonv::kind::array, kind());
-    auto iter = _data.array->_values.begin() + std::distance(const_array_iterator(begin_array()), position);
-    iter = _data.array->_values.insert(iter, std::move(item));
-    return begin_array() + std::distance(_data.array->_values.begin(), iter);
+    auto& values = detail::unshare(_fields.data.array)->_values;
+    auto  iter   = values.begin() + std::distance(const_array_iterator(begin_array()), position);
+    iter = values.insert(iter, std::move(item));
+    return begin_array() + std::distance(_fields.data.array->_values.begin(), iter);
 }
 
 void value::assign(size_type count, const value& val)
 {
     check_type(jsonv::kind::array, kind());
-    _data.array->_values.assign(count, val);
+    detail::unshare(_fields.data.array)->_values.assign(count, val);
 }
 
 void value::assign(std::initializer_list<value> items)
 {
     check_type(jsonv::kind::array, kind());
-    _data.array->_values.assign(std::move(items));
+    detail::unshare(_fields.data.array)->_values.assign(std::move(items));
 }
 
 void value::resize(size_type count, const value& val)
 {
     check_type(jsonv::kind::array, kind());
-    _data.array->_values.resize(count, val);
+    detail::unshare(_fields.data.array)->_values.resize(count, val);
+}
+
+void value::reserve(size_type count)
+{
+    check_type(jsonv::kind::array, kind());
+    detail::unshare(_fields.data.array)->_values.reserve(count);
 }
 
 value::array_iterator value::erase(const_array_iterator position)
 {
     check_type(jsonv::kind::array, kind());
     difference_type dist(position - begin_array());
-    _data.array->_values.erase(_data.array->_values.begin() + dist);
+    auto& values = detail::unshare(_fields.data.array)->_values;
+    values.erase(values.begin() + dist);
     return array_iterator(this, static_cast<size_type>(dist));
 }
 
@@ -181,9 +206,8 @@ value::array_iterator value::erase(const_array_iterator first, const_array_itera
 {
     difference_type fdist(first - begin_array());
     difference_type ldist(last  - begin_array());
-    _data.array->_values.erase(_data.array->_values.begin() + fdist,
-                               _data.array->_values.begin() + ldist
-                              );
+    auto& values = detail::unshare(_fields.data.array)->_values;
+    values.erase(values.begin() + fdist, values.begin() + ldist);
     return array_iterator(this, static_cast<size_type>(fdist));
 }
 
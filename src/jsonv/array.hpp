@@ -15,7 +15,7 @@
 #include <jsonv/value.hpp>
 #include <jsonv/detail.hpp>
 
-#include <deque>
+#include <vector>
 
 namespace jsonv
 {
@@ -26,7 +26,14 @@ class JSONV_LOCAL array_impl :
         public cloneable<array_impl>
 {
 public:
-    typedef std::deque<jsonv::value> array_type;
+    typedef std::vector<jsonv::value, arena_allocator<jsonv::value>> array_type;
+    
+public:
+    array_impl() = default;
+    
+    explicit array_impl(arena* region) :
+            _values(array_type::allocator_type(region))
+    { }
     
 public:
     value::size_type size() const;
@@ -22,6 +22,7 @@
 #include <sstream>
 #include <stdexcept>
 
+#include "detail/char_scan.hpp"
 #include "detail/fixed_map.hpp"
 
 #if __cplusplus >= 201703L || defined __has_include
@@ -206,12 +207,15 @@ static bool utf8_extract_code(const char* c, unsigned length, char bitmask, char
 
 static const char hex_codes[] = "0123456789abcdef";
 
-static void to_hex(std::ostream& stream, uint16_t code)
+/** Write the 6 characters of the \c "\\uXXXX" escape of \a code to \a out. **/
+static void to_unicode_escape(char* out, uint16_t code)
 {
+    out[0] = '\\';
+    out[1] = 'u';
     for (int pos = 3; pos >= 0; --pos)
     {
         uint16_t local_code = (code >> (4 * pos)) & uint16_t(0x000f);
-        stream << hex_codes[local_code];
+        out[5 - pos] = hex_codes[local_code];
     }
 }
 
@@ -228,17 +232,33 @@ static void utf16_create_surrogates(char32_t codepoint, uint16_t* high, uint16_t
     *low  = uint16_t(val & 0x03ff) | 0xdc00;
 }
 
-std::ostream& string_encode(std::ostream& stream, string_view source, bool ensure_ascii)
+void string_encode(string_encode_sink sink, void* context, string_view source, bool ensure_ascii)
 {
     typedef string_view::size_type size_type;
 
+    // Characters which do not need to be escaped are written in runs, which start at run_begin
+    size_type run_begin = 0;
+    auto flush_run = [&] (size_type run_end)
+                     {
+                         if (run_end > run_begin)
+                             sink(context, source.data() + run_begin, run_end - run_begin);
+                     };
+
+    const char* source_end = source.data() + source.size();
     for (size_type idx = 0, source_size = source.size(); idx < source_size; /* incremented inline */)
     {
+        // Skip over everything which can not need escaping a block at a time -- it is all part of the current run
+        idx = size_type(scan_string_escape(source.data() + idx, source_end) - source.data());
+        if (idx == source_size)
+            break;
+
         const char& current = source[idx];
         if (const char* replacement = find_encoding(current))
         {
-            stream << "\\" << *replacement;
-            ++idx;
+            flush_run(idx);
+            const char escape[] = { '\\', *replacement };
+            sink(context, escape, sizeof escape);
+            run_begin = ++idx;
         }
         else
         {
@@ -248,49 +268,63 @@ std::ostream& string_encode(std::ostream& stream, string_view source, bool ensur
 
             if (!needs_unicode_escaping(current))
             {
-                stream << current;
+                ++idx;
+                continue;
             }
-            else
+
+            char32_t code;
+            if (!valid_utf8
+               || idx + length > source_size
+               || !utf8_extract_code(&current, length, bitmask, code)
+               )
             {
-                char32_t code;
-                if (!valid_utf8
-                   || idx + length > source_size
-                   || !utf8_extract_code(&current, length, bitmask, code)
-                   )
-                {
-                    // Invalid UTF-8 encoding -- we're either at the end of the string or the bytes were not a valid
-                    // UTF-8 sequence. In either case, we will drop in a numeric encoding (\u00NN) for the bytes.
-                    length = 1;
-                    code = char32_t(current) & 0xff;
-                }
+                // Invalid UTF-8 encoding -- we're either at the end of the string or the bytes were not a valid
+                // UTF-8 sequence. In either case, we will drop in a numeric encoding (\u00NN) for the bytes.
+                length = 1;
+                code = char32_t(current) & 0xff;
+            }
 
-                // if the input string is valid UTF-8, let it pass through
-                if (valid_utf8 && !ensure_ascii)
-                {
-                    stream.write(&current, length);
-                }
-                // basic multilingual plane points are encoded in hex
-                else if (code < 0x10000)
-                {
-                    stream << "\\u";
-                    to_hex(stream, uint16_t(code));
-                }
-                // Codepoints not in the basic multilingual plane must be encoded as surrogate pairs
-                else
-                {
-                    uint16_t high, low;
-                    utf16_create_surrogates(code, &high, &low);
-                    stream << "\\u";
-                    to_hex(stream, high);
-                    stream << "\\u";
-                    to_hex(stream, low);
-                }
+            // if the input string is valid UTF-8, let it pass through
+            if (valid_utf8 && !ensure_ascii)
+            {
+                idx += length;
+                continue;
             }
 
+            flush_run(idx);
+            char escape[12];
+            // basic multilingual plane points are encoded in hex
+            if (code < 0x10000)
+            {
+                to_unicode_escape(escape, uint16_t(code));
+                sink(context, escape, 6);
+            }
+            // Codepoints not in the basic multilingual plane must be encoded as surrogate pairs
+            else
+            {
+                uint16_t high, low;
+                utf16_create_surrogates(code, &high, &low);
+                to_unicode_escape(escape, high);
+                to_unicode_escape(escape + 6, low);
+                sink(context, escape, 12);
+            }
             idx += length;
+            run_begin = idx;
         }
     }
+    flush_run(source.size());
+}
 
+std::ostream& string_encode(std::ostream& stream, string_view source, bool ensure_ascii)
+{
+    string_encode([] (void* context, const char* text, std::size_t size)
+                  {
+                      static_cast<std::ostream*>(context)->write(text, std::streamsize(size));
+                  },
+                  &stream,
+                  source,
+                  ensure_ascii
+                 );
     return stream;
 }
 
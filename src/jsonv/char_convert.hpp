@@ -15,6 +15,8 @@
 #include <jsonv/parse.hpp>
 #include <jsonv/string_view.hpp>
 
+#include <cstddef>
+#include <iosfwd>
 #include <string>
 #include <stdexcept>
 
@@ -42,6 +44,14 @@ private:
     size_type _offset;
 };
 
+/** A function which \c string_encode calls to write the \a size characters at \a text to the output \a context. **/
+typedef void (*string_encode_sink)(void* context, const char* text, std::size_t size);
+
+/** Encodes C++ string \a source into a fully-escaped JSON string by calling \a sink with \a context. Characters which
+ *  do not need to be escaped are given to \a sink in runs as long as possible.
+**/
+void string_encode(string_encode_sink sink, void* context, string_view source, bool ensure_ascii = true);
+
 /** Encodes C++ string \a source into a fully-escaped JSON string into \a stream ready for sending over the wire.
 **/
 std::ostream& string_encode(std::ostream& stream, string_view source, bool ensure_ascii = true);
@@ -98,7 +98,7 @@ std::vector<value> coerce_array(const value& from)
 std::string coerce_string(const value& from)
 {
     if (from.kind() == kind::string)
-        return from.as_string();
+        return std::string(from.as_string_view());
     else
         return to_string(from);
 }
@@ -119,7 +119,7 @@ std::int64_t coerce_integer(const value& from)
     case kind::string:
         try
         {
-            value x = parse(from.as_string());
+            value x = parse(from.as_string_view());
             if (x.kind() == kind::integer || x.kind() == kind::decimal || x.kind() == kind::null)
                 return coerce_integer(x);
         }
@@ -146,7 +146,7 @@ double coerce_decimal(const value& from)
     case kind::string:
         try
         {
-            value x = parse(from.as_string());
+            value x = parse(from.as_string_view());
             if (x.kind() == kind::integer || x.kind() == kind::decimal || x.kind() == kind::null)
                 return x.as_decimal();
         }
@@ -210,7 +210,7 @@ value coerce_merge(value a, value b)
         a["undefined"] = std::move(b);
         return a;
     case kind::string:
-        return a.as_string() + coerce_string(b);
+        return std::string(a.as_string_view()) + coerce_string(b);
     default:
         throw kind_error(to_string(a.kind()));
     }
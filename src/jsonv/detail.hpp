@@ -11,26 +11,181 @@
 #ifndef __JSONV_DETAIL_HPP_INCLUDED__
 #define __JSONV_DETAIL_HPP_INCLUDED__
 
+#include <jsonv/forward.hpp>
+#include <jsonv/parse.hpp>
+#include <jsonv/path.hpp>
 #include <jsonv/value.hpp>
 #include <jsonv/string_view.hpp>
 
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+
 namespace jsonv
 {
 namespace detail
 {
 
+/** The base of the heap-allocated nodes of a \c value.
+ *  
+ *  Nodes can be \e shareable (see \c value::enable_sharing), in which case copying a \c value adds a reference to the
+ *  same node instead of cloning it. A shareable node is immutable while more than one \c value refers to it, so every
+ *  mutating operation must call \c unshare first.
+**/
 template <typename T>
 struct cloneable
 {
+    /** Copy this node onto the heap. This is always the heap, even if this node lives in an \c arena. The children of
+     *  the node are copied like any other \c value, so the shareable ones are shared with the original.
+    **/
     T* clone() const
     {
         return new T(*static_cast<const T*>(this));
     }
+    
+    /** Get a node with the same contents as this one for a copy of a \c value. For a shareable node, this is the node
+     *  itself with an added reference; otherwise, it is a \c clone. An exposed node (see \c expose) is always cloned,
+     *  since references into it must keep referring to the original's contents only.
+    **/
+    T* copy() const
+    {
+        if (!_shareable || _exposed)
+            return clone();
+        
+        _refs.fetch_add(1, std::memory_order_relaxed);
+        return const_cast<T*>(static_cast<const T*>(this));
+    }
+    
+    /** Is this node referred to by more than one \c value? **/
+    bool shared() const
+    {
+        return _shareable && _refs.load(std::memory_order_acquire) > 1;
+    }
+    
+    bool shareable() const
+    {
+        return _shareable;
+    }
+    
+    /** Allow copies of this node to share it. Nodes in an \c arena can not be shared, since copies must be able to
+     *  outlive the \c arena. This must only be called by the only owner of this node.
+    **/
+    void enable_sharing()
+    {
+        if (!_region)
+            _shareable = true;
+        _exposed = false;
+    }
+    
+    /** Has a mutable reference or iterator into this node been handed out since sharing was last enabled? **/
+    bool exposed() const
+    {
+        return _exposed;
+    }
+    
+    /** Note that a mutable reference or iterator into this node is being handed out. This must only be called by the
+     *  only owner of this node.
+    **/
+    void expose()
+    {
+        _exposed = true;
+    }
+    
+    /** The \c arena this node was allocated from or \c nullptr if it lives on the heap. **/
+    arena* region() const
+    {
+        return _region;
+    }
+    
+    /** Create a new \c T from \a region or the heap if \a region is \c nullptr. **/
+    static T* create(arena* region)
+    {
+        if (!region)
+            return new T();
+        
+        T* out = new(region->allocate(sizeof(T), alignof(T))) T(region);
+        out->_region = region;
+        return out;
+    }
+    
+    /** Destroy a node created by \c create or \c clone. Memory from an \c arena is not freed. **/
+    static void destroy(T* node) noexcept
+    {
+        if (node->_region)
+            node->~T();
+        else
+            delete node;
+    }
+    
+    /** Drop a reference to \a node, destroying it if this was the last one. **/
+    static void release(T* node) noexcept
+    {
+        if (node->_shareable && node->_refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        
+        destroy(node);
+    }
+    
+protected:
+    cloneable() = default;
+    
+    // A copy is always made on the heap and is only referred to by the value it was made for
+    cloneable(const cloneable& source) :
+            _region(nullptr),
+            _shareable(source._shareable),
+            _exposed(false),
+            _refs(1)
+    { }
+    
+    cloneable& operator=(const cloneable&)
+    {
+        return *this;
+    }
+    
+private:
+    arena*                           _region    = nullptr;
+    bool                             _shareable = false;
+    bool                             _exposed   = false;
+    mutable std::atomic<std::size_t> _refs{1};
 };
 
+/** Make sure \a node is only referred to by the \c value which owns the \a node pointer, replacing it with a clone if
+ *  it is shared. Call this before modifying a node.
+**/
+template <typename T>
+T* unshare(T*& node)
+{
+    if (node->shared())
+    {
+        T* copy = node->clone();
+        T::release(node);
+        node = copy;
+    }
+    return node;
+}
+
+/** Like \c unshare, but for handing out a mutable reference or iterator into \a node. Copies made while such a
+ *  reference might still be in use clone \a node instead of sharing it, so writes through the reference only ever
+ *  change the \c value it was taken from. Modifications which hand out nothing into the node should use \c unshare.
+**/
+template <typename T>
+T* expose(T*& node)
+{
+    unshare(node)->expose();
+    return node;
+}
+
 class string_impl :
         public cloneable<string_impl>
 {
+public:
+    string_impl() = default;
+    
+    explicit string_impl(arena*)
+    { }
+    
 public:
     std::string _string;
 };
@@ -43,6 +198,81 @@ void check_type(kind expected, kind actual);
 void check_type(std::initializer_list<kind> expected, kind actual);
 std::ostream& stream_escaped_string(std::ostream& stream, string_view str, bool require_ascii);
 
+/** Follow the path `[first, last)` from \a current. This works for anything with the lookup functions of \c value, so
+ *  the same rules apply to a \c value and a \c lazy_value.
+**/
+template <typename TValueRef, typename TPathIterator, typename FOnNonexistantPath>
+TValueRef walk_path(TValueRef&&               current,
+                    TPathIterator             first,
+                    TPathIterator             last,
+                    const FOnNonexistantPath& on_nonexistant_path
+                   )
+{
+    if (first == last)
+        return current;
+    
+    const path_element& elem = *first;
+    switch (elem.kind())
+    {
+    case path_element_kind::array_index:
+        check_type({ jsonv::kind::array, jsonv::kind::null }, current.kind());
+        if (current.kind() != jsonv::kind::array || elem.index() >= current.size())
+            on_nonexistant_path(elem, current);
+        return walk_path(current.at(elem.index()), std::next(first), last, on_nonexistant_path);
+    case path_element_kind::object_key:
+        check_type({ jsonv::kind::object, jsonv::kind::null }, current.kind());
+        if (current.kind() != jsonv::kind::object || !current.count(elem.key()))
+            on_nonexistant_path(elem, current);
+        return walk_path(current.at(elem.key()), std::next(first), last, on_nonexistant_path);
+    default:
+        throw std::runtime_error(to_string(elem));
+    }
+}
+
+/** Parse the value which starts at the current token of \a input, leaving \a input at the last token of it. Unlike
+ *  \c parse, nothing after the value is looked at. This is how \c reader::read_value works.
+**/
+value parse_current(tokenizer& input, const parse_options& options);
+
+/** Parse all of \a input like \c parse, as if it were nested inside of \a depth arrays or objects. This only changes
+ *  where \c parse_options::max_structure_depth is reached. This is how \c parse_parallel parses each element.
+**/
+value parse_nested(const string_view& input, const parse_options& options, std::size_t depth);
+
+namespace detail
+{
+
+/** Parses a series of separate inputs with the same \c parse_options, keeping the \c tokenizer and the state of the
+ *  parser between them instead of setting them up again for each one. This is how \c parser and \c ndjson_reader
+ *  work.
+**/
+class record_parser
+{
+public:
+    explicit record_parser(const parse_options& options);
+    
+    record_parser(const record_parser&) = delete;
+    record_parser& operator=(const record_parser&) = delete;
+    
+    ~record_parser() noexcept;
+    
+    const parse_options& options() const;
+    
+    /** Parse all of \a input like \c parse, allocating the result from \a region if it is not \c nullptr. Instead of
+     *  throwing a \c parse_error, the problems are put in \a problems, which is left empty if there are none, and the
+     *  partial result is returned.
+    **/
+    value parse(const string_view& input, parse_error::problem_list& problems, arena* region = nullptr);
+    
+private:
+    struct impl;
+    
+private:
+    std::unique_ptr<impl> _impl;
+};
+
+}
+
 }
 
 #endif/*__JSONV_DETAIL_HPP_INCLUDED__*/
@@ -0,0 +1,398 @@
+/** \file
+ *
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv/detail/char_scan.hpp>
+
+#include <ostream>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#   define JSONV_SCAN_SSE2 1
+#   if defined(__clang__) || __GNUC__ >= 5 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)
+#       define JSONV_SCAN_AVX2 1
+#   else
+#       define JSONV_SCAN_AVX2 0
+#   endif
+#   define JSONV_SCAN_TARGET(isa_) __attribute__((target(isa_)))
+#   include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#   define JSONV_SCAN_SSE2 1
+#   define JSONV_SCAN_AVX2 0
+#   define JSONV_SCAN_TARGET(isa_)
+#   include <intrin.h>
+#else
+#   define JSONV_SCAN_SSE2 0
+#   define JSONV_SCAN_AVX2 0
+#endif
+
+namespace jsonv
+{
+namespace detail
+{
+
+std::ostream& operator<<(std::ostream& os, const scan_isa& isa)
+{
+    switch (isa)
+    {
+    case scan_isa::scalar: return os << "scalar";
+    case scan_isa::sse2:   return os << "sse2";
+    case scan_isa::avx2:   return os << "avx2";
+    default:               return os << "scan_isa(" << static_cast<int>(isa) << ")";
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// scalar                                                                                                             //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static bool is_whitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static const char* scan_string_special_scalar(const char* begin, const char* end)
+{
+    for ( ; begin != end; ++begin)
+    {
+        if (*begin == '\"' || *begin == '\\')
+            return begin;
+    }
+    return end;
+}
+
+static const char* scan_string_unusual_scalar(const char* begin, const char* end)
+{
+    for ( ; begin != end; ++begin)
+    {
+        auto c = static_cast<unsigned char>(*begin);
+        if (c == '\"' || c == '\\' || c < 0x20 || c >= 0x7f)
+            return begin;
+    }
+    return end;
+}
+
+static const char* scan_string_escape_scalar(const char* begin, const char* end)
+{
+    for ( ; begin != end; ++begin)
+    {
+        auto c = static_cast<unsigned char>(*begin);
+        if (c == '\"' || c == '\\' || c == '/' || c < 0x20 || c >= 0x7f)
+            return begin;
+    }
+    return end;
+}
+
+static const char* scan_whitespace_scalar(const char* begin, const char* end)
+{
+    for ( ; begin != end; ++begin)
+    {
+        if (!is_whitespace(*begin))
+            return begin;
+    }
+    return end;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SSE2                                                                                                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if JSONV_SCAN_SSE2
+
+static unsigned count_trailing_zeros(unsigned mask)
+{
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward(&idx, mask);
+    return unsigned(idx);
+#else
+    return unsigned(__builtin_ctz(mask));
+#endif
+}
+
+JSONV_SCAN_TARGET("sse2")
+static const char* scan_string_special_sse2(const char* begin, const char* end)
+{
+    const __m128i quote   = _mm_set1_epi8('\"');
+    const __m128i solidus = _mm_set1_epi8('\\');
+
+    for ( ; end - begin >= 16; begin += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        __m128i match = _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, solidus));
+        if (unsigned mask = unsigned(_mm_movemask_epi8(match)))
+            return begin + count_trailing_zeros(mask);
+    }
+    return scan_string_special_scalar(begin, end);
+}
+
+JSONV_SCAN_TARGET("sse2")
+static const char* scan_string_unusual_sse2(const char* begin, const char* end)
+{
+    const __m128i quote   = _mm_set1_epi8('\"');
+    const __m128i solidus = _mm_set1_epi8('\\');
+    const __m128i space   = _mm_set1_epi8(' ');
+    const __m128i del     = _mm_set1_epi8('\x7f');
+
+    for ( ; end - begin >= 16; begin += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        // The comparison is signed, so anything at or above 0x80 is also less than ' '
+        __m128i match = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, solidus)),
+                                     _mm_or_si128(_mm_cmplt_epi8(block, space), _mm_cmpeq_epi8(block, del))
+                                    );
+        if (unsigned mask = unsigned(_mm_movemask_epi8(match)))
+            return begin + count_trailing_zeros(mask);
+    }
+    return scan_string_unusual_scalar(begin, end);
+}
+
+JSONV_SCAN_TARGET("sse2")
+static const char* scan_string_escape_sse2(const char* begin, const char* end)
+{
+    const __m128i quote   = _mm_set1_epi8('\"');
+    const __m128i solidus = _mm_set1_epi8('\\');
+    const __m128i slash   = _mm_set1_epi8('/');
+    const __m128i space   = _mm_set1_epi8(' ');
+    const __m128i del     = _mm_set1_epi8('\x7f');
+
+    for ( ; end - begin >= 16; begin += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        // The comparison is signed, so anything at or above 0x80 is also less than ' '
+        __m128i match = _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, solidus));
+        match = _mm_or_si128(match, _mm_cmpeq_epi8(block, slash));
+        match = _mm_or_si128(match, _mm_or_si128(_mm_cmplt_epi8(block, space), _mm_cmpeq_epi8(block, del)));
+        if (unsigned mask = unsigned(_mm_movemask_epi8(match)))
+            return begin + count_trailing_zeros(mask);
+    }
+    return scan_string_escape_scalar(begin, end);
+}
+
+JSONV_SCAN_TARGET("sse2")
+static const char* scan_whitespace_sse2(const char* begin, const char* end)
+{
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab   = _mm_set1_epi8('\t');
+    const __m128i lf    = _mm_set1_epi8('\n');
+    const __m128i cr    = _mm_set1_epi8('\r');
+
+    for ( ; end - begin >= 16; begin += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        __m128i match = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, space), _mm_cmpeq_epi8(block, tab)),
+                                     _mm_or_si128(_mm_cmpeq_epi8(block, lf),    _mm_cmpeq_epi8(block, cr))
+                                    );
+        if (unsigned mask = ~unsigned(_mm_movemask_epi8(match)) & 0xffffU)
+            return begin + count_trailing_zeros(mask);
+    }
+    return scan_whitespace_scalar(begin, end);
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// AVX2                                                                                                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if JSONV_SCAN_AVX2
+
+JSONV_SCAN_TARGET("avx2")
+static const char* scan_string_special_avx2(const char* begin, const char* end)
+{
+    const __m256i quote   = _mm256_set1_epi8('\"');
+    const __m256i solidus = _mm256_set1_epi8('\\');
+
+    for ( ; end - begin >= 32; begin += 32)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        __m256i match = _mm256_or_si256(_mm256_cmpeq_epi8(block, quote), _mm256_cmpeq_epi8(block, solidus));
+        if (unsigned mask = unsigned(_mm256_movemask_epi8(match)))
+            return begin + count_trailing_zeros(mask);
+    }
+    return scan_string_special_sse2(begin, end);
+}
+
+JSONV_SCAN_TARGET("avx2")
+static const char* scan_string_unusual_avx2(const char* begin, const char* end)
+{
+    const __m256i quote   = _mm256_set1_epi8('\"');
+    const __m256i solidus = _mm256_set1_epi8('\\');
+    const __m256i space   = _mm256_set1_epi8(' ');
+    const __m256i del     = _mm256_set1_epi8('\x7f');
+
+    for ( ; end - begin >= 32; begin += 32)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        // The comparison is signed, so anything at or above 0x80 is also less than ' '
+        __m256i match = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, quote), _mm256_cmpeq_epi8(block, solidus)),
+                                        _mm256_or_si256(_mm256_cmpgt_epi8(space, block), _mm256_cmpeq_epi8(block, del))
+                                       );
+        if (unsigned mask = unsigned(_mm256_movemask_epi8(match)))
+            return begin + count_trailing_zeros(mask);
+    }
+    return scan_string_unusual_sse2(begin, end);
+}
+
+JSONV_SCAN_TARGET("avx2")
+static const char* scan_string_escape_avx2(const char* begin, const char* end)
+{
+    const __m256i quote   = _mm256_set1_epi8('\"');
+    const __m256i solidus = _mm256_set1_epi8('\\');
+    const __m256i slash   = _mm256_set1_epi8('/');
+    const __m256i space   = _mm256_set1_epi8(' ');
+    const __m256i del     = _mm256_set1_epi8('\x7f');
+
+    for ( ; end - begin >= 32; begin += 32)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        // The comparison is signed, so anything at or above 0x80 is also less than ' '
+        __m256i match = _mm256_or_si256(_mm256_cmpeq_epi8(block, quote), _mm256_cmpeq_epi8(block, solidus));
+        match = _mm256_or_si256(match, _mm256_cmpeq_epi8(block, slash));
+        match = _mm256_or_si256(match, _mm256_or_si256(_mm256_cmpgt_epi8(space, block), _mm256_cmpeq_epi8(block, del)));
+        if (unsigned mask = unsigned(_mm256_movemask_epi8(match)))
+            return begin + count_trailing_zeros(mask);
+    }
+    return scan_string_escape_sse2(begin, end);
+}
+
+JSONV_SCAN_TARGET("avx2")
+static const char* scan_whitespace_avx2(const char* begin, const char* end)
+{
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab   = _mm256_set1_epi8('\t');
+    const __m256i lf    = _mm256_set1_epi8('\n');
+    const __m256i cr    = _mm256_set1_epi8('\r');
+
+    for ( ; end - begin >= 32; begin += 32)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        __m256i match = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, space), _mm256_cmpeq_epi8(block, tab)),
+                                        _mm256_or_si256(_mm256_cmpeq_epi8(block, lf),    _mm256_cmpeq_epi8(block, cr))
+                                       );
+        if (unsigned mask = ~unsigned(_mm256_movemask_epi8(match)))
+            return begin + count_trailing_zeros(mask);
+    }
+    return scan_whitespace_sse2(begin, end);
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Dispatch                                                                                                           //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+struct scan_functions
+{
+    using scan_fn = const char* (*)(const char*, const char*);
+
+    scan_isa isa;
+    scan_fn  string_special;
+    scan_fn  string_unusual;
+    scan_fn  string_escape;
+    scan_fn  whitespace;
+};
+
+}
+
+static scan_functions scan_functions_for(scan_isa isa)
+{
+    switch (isa)
+    {
+#if JSONV_SCAN_AVX2
+    case scan_isa::avx2:
+        return { scan_isa::avx2,
+                 scan_string_special_avx2,
+                 scan_string_unusual_avx2,
+                 scan_string_escape_avx2,
+                 scan_whitespace_avx2
+               };
+#endif
+#if JSONV_SCAN_SSE2
+    case scan_isa::sse2:
+        return { scan_isa::sse2,
+                 scan_string_special_sse2,
+                 scan_string_unusual_sse2,
+                 scan_string_escape_sse2,
+                 scan_whitespace_sse2
+               };
+#endif
+    case scan_isa::scalar:
+    default:
+        return { scan_isa::scalar,
+                 scan_string_special_scalar,
+                 scan_string_unusual_scalar,
+                 scan_string_escape_scalar,
+                 scan_whitespace_scalar
+               };
+    }
+}
+
+scan_isa best_scan_isa()
+{
+#if JSONV_SCAN_SSE2 && defined(__GNUC__)
+    __builtin_cpu_init();
+#endif
+#if JSONV_SCAN_AVX2
+    if (__builtin_cpu_supports("avx2"))
+        return scan_isa::avx2;
+#endif
+#if JSONV_SCAN_SSE2 && defined(__GNUC__)
+    if (__builtin_cpu_supports("sse2"))
+        return scan_isa::sse2;
+#elif JSONV_SCAN_SSE2
+    return scan_isa::sse2;
+#endif
+    return scan_isa::scalar;
+}
+
+static scan_functions& active_scan_functions()
+{
+    static scan_functions instance = scan_functions_for(best_scan_isa());
+    return instance;
+}
+
+scan_isa active_scan_isa()
+{
+    return active_scan_functions().isa;
+}
+
+scan_isa set_scan_isa(scan_isa isa)
+{
+    if (static_cast<unsigned char>(isa) > static_cast<unsigned char>(best_scan_isa()))
+        isa = best_scan_isa();
+
+    active_scan_functions() = scan_functions_for(isa);
+    return active_scan_isa();
+}
+
+const char* scan_string_special(const char* begin, const char* end)
+{
+    return active_scan_functions().string_special(begin, end);
+}
+
+const char* scan_string_unusual(const char* begin, const char* end)
+{
+    return active_scan_functions().string_unusual(begin, end);
+}
+
+const char* scan_string_escape(const char* begin, const char* end)
+{
+    return active_scan_functions().string_escape(begin, end);
+}
+
+const char* scan_whitespace(const char* begin, const char* end)
+{
+    return active_scan_functions().whitespace(begin, end);
+}
+
+}
+}
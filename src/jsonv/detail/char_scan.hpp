@@ -0,0 +1,83 @@
+/** \file jsonv/detail/char_scan.hpp
+ *  Block-at-a-time character scanning used by the tokenizer and the string encoder. The scanners look at 16 (SSE2) or
+ *  32 (AVX2) bytes at a time when the CPU supports it and fall back to a byte-by-byte loop otherwise. The
+ *  implementation is selected once at runtime based on the capabilities of the machine.
+ *
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#ifndef __JSONV_DETAIL_CHAR_SCAN_HPP_INCLUDED__
+#define __JSONV_DETAIL_CHAR_SCAN_HPP_INCLUDED__
+
+#include <jsonv/config.hpp>
+
+#include <iosfwd>
+
+namespace jsonv
+{
+namespace detail
+{
+
+/** The instruction set a scanner uses. **/
+enum class scan_isa : unsigned char
+{
+    /** Plain C++ -- look at one byte at a time. **/
+    scalar,
+    /** Look at 16 bytes at a time with SSE2. **/
+    sse2,
+    /** Look at 32 bytes at a time with AVX2. **/
+    avx2,
+};
+
+std::ostream& operator<<(std::ostream&, const scan_isa&);
+
+/** Get the best \c scan_isa supported by the running CPU. **/
+scan_isa best_scan_isa();
+
+/** Get the \c scan_isa currently used by the scanning functions. This is \c best_scan_isa unless it was overridden by
+ *  \c set_scan_isa.
+**/
+scan_isa active_scan_isa();
+
+/** Override the scanning implementation. This is meant for testing and benchmarking -- it is not thread-safe with
+ *  concurrent scanning. Requesting an \a isa the CPU does not support selects the best one which is supported.
+ *
+ *  \returns the \c scan_isa which is now active.
+**/
+scan_isa set_scan_isa(scan_isa isa);
+
+/** Find the first character in `[begin, end)` which could end the body of a JSON string: either a \c '"' or a \c '\\'.
+ *
+ *  \returns a pointer to the found character or \a end if there is no such character.
+**/
+const char* scan_string_special(const char* begin, const char* end);
+
+/** Like \c scan_string_special, but also stop at any character which would prevent the body of a JSON string from being
+ *  used as-is: control characters (below \c 0x20), \c DEL and anything outside of ASCII.
+ *
+ *  \returns a pointer to the found character or \a end if there is no such character.
+**/
+const char* scan_string_unusual(const char* begin, const char* end);
+
+/** Like \c scan_string_unusual, but also stop at \c '/'. These are the characters which \c string_encode might need to
+ *  escape -- everything before the found character can be copied to the output as-is.
+ *
+ *  \returns a pointer to the found character or \a end if there is no such character.
+**/
+const char* scan_string_escape(const char* begin, const char* end);
+
+/** Find the first character in `[begin, end)` which is not JSON whitespace (space, tab, carriage return or line feed).
+ *
+ *  \returns a pointer to the found character or \a end if the whole range is whitespace.
+**/
+const char* scan_whitespace(const char* begin, const char* end);
+
+}
+}
+
+#endif/*__JSONV_DETAIL_CHAR_SCAN_HPP_INCLUDED__*/
@@ -0,0 +1,743 @@
+/** \file
+ *
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv/detail/number_convert.hpp>
+
+#include <cfloat>
+#include <cmath>
+#include <clocale>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#if defined(_MSC_VER)
+#   define JSONV_HAS_STRTOD_L 1
+#elif defined(__GLIBC__) || defined(__APPLE__) || defined(__FreeBSD__)
+#   include <locale.h>
+#   if !defined(__GLIBC__)
+#       include <xlocale.h>
+#   endif
+#   define JSONV_HAS_STRTOD_L 1
+#else
+#   define JSONV_HAS_STRTOD_L 0
+#   include <locale>
+#   include <sstream>
+#endif
+
+namespace jsonv
+{
+namespace detail
+{
+
+static bool is_digit(char c)
+{
+    return '0' <= c && c <= '9';
+}
+
+/** Powers of 10 which are exactly representable as a \c double. **/
+static const double exact_powers_of_ten[] =
+{
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static const int max_exact_power_of_ten = 22;
+
+/** Every integer up to 2^53 is exactly representable as a \c double. **/
+static const std::uint64_t max_exact_mantissa = std::uint64_t(1) << 53;
+
+/** Attempt the conversion of `mantissa * 10^exponent` using only exact operations. If both the mantissa and the power of
+ *  10 are exactly representable, a single IEEE multiplication or division produces the correctly-rounded result (see
+ *  William D. Clinger, "How to Read Floating Point Numbers Accurately"). This covers the vast majority of numbers seen
+ *  in practice.
+ *
+ *  \returns \c true if the conversion was performed.
+**/
+static bool decode_decimal_exact(std::uint64_t mantissa, int exponent, double& out)
+{
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    if (mantissa > max_exact_mantissa)
+        return false;
+
+    // Something like 12e25 can still be done by pushing the extra zeros into the mantissa: 12000e22
+    if (exponent > max_exact_power_of_ten)
+    {
+        for ( ; exponent > max_exact_power_of_ten; --exponent)
+        {
+            mantissa *= 10;
+            if (mantissa > max_exact_mantissa)
+                return false;
+        }
+    }
+
+    if (exponent < -max_exact_power_of_ten)
+        return false;
+
+    double value = double(mantissa);
+    if (exponent < 0)
+        out = value / exact_powers_of_ten[-exponent];
+    else
+        out = value * exact_powers_of_ten[exponent];
+    return true;
+#else
+    // With extended precision intermediates, the operation above can be double-rounded
+    (void) mantissa;
+    (void) exponent;
+    (void) out;
+    return false;
+#endif
+}
+
+/** The slow path for decimals: let \c strtod do the work in the "C" locale. Plain \c strtod uses the global locale,
+ *  which might not use '.' as the decimal point and can be changed by \c setlocale while another thread is parsing. The
+ *  locale-taking variant is given a "C" locale created once and never modified. Where there is no such variant, a
+ *  stream imbued with the classic locale is used instead, which is slower but just as independent of the global locale.
+ *  The token was already validated by \c decode_number, so it only needs a null-terminated copy.
+**/
+static bool decode_decimal_fallback(string_view text, double& out)
+{
+    std::string buffer(text.data(), text.size());
+
+#if JSONV_HAS_STRTOD_L
+    char* scan_end = nullptr;
+#   if defined(_MSC_VER)
+    static const _locale_t c_locale = _create_locale(LC_NUMERIC, "C");
+    out = _strtod_l(buffer.c_str(), &scan_end, c_locale);
+#   else
+    static const locale_t c_locale = newlocale(LC_NUMERIC_MASK, "C", locale_t(0));
+    out = strtod_l(buffer.c_str(), &scan_end, c_locale);
+#   endif
+    return scan_end == buffer.c_str() + buffer.size();
+#else
+    std::istringstream stream(buffer);
+    stream.imbue(std::locale::classic());
+    stream >> out;
+    // Out of range values leave the largest finite value where strtod would give infinity
+    if (stream.fail() && std::abs(out) == std::numeric_limits<double>::max())
+        out = std::copysign(std::numeric_limits<double>::infinity(), out);
+    return stream.eof();
+#endif
+}
+
+bool decode_number(string_view text, decoded_number& out)
+{
+    const char* iter = text.data();
+    const char* end  = text.data() + text.size();
+
+    bool negative = iter != end && *iter == '-';
+    if (negative)
+        ++iter;
+
+    if (iter == end || !is_digit(*iter))
+        return false;
+
+    // Collect the digits into mantissa. If there are too many to fit, remember that and let the fallback deal with it.
+    std::uint64_t mantissa  = 0;
+    bool          truncated = false;
+    int           exponent  = 0;
+
+    auto add_digit = [&] (char c)
+                     {
+                         unsigned digit = unsigned(c - '0');
+                         if (!truncated && mantissa <= (std::numeric_limits<std::uint64_t>::max() - digit) / 10)
+                             mantissa = mantissa * 10 + digit;
+                         else
+                             truncated = true;
+                     };
+
+    for ( ; iter != end && is_digit(*iter); ++iter)
+        add_digit(*iter);
+
+    bool is_integer = true;
+    if (iter != end && *iter == '.')
+    {
+        is_integer = false;
+        ++iter;
+        if (iter == end || !is_digit(*iter))
+            return false;
+
+        for ( ; iter != end && is_digit(*iter); ++iter)
+        {
+            add_digit(*iter);
+            --exponent;
+        }
+    }
+
+    if (iter != end && (*iter == 'e' || *iter == 'E'))
+    {
+        is_integer = false;
+        ++iter;
+
+        bool negative_exponent = false;
+        if (iter != end && (*iter == '-' || *iter == '+'))
+        {
+            negative_exponent = *iter == '-';
+            ++iter;
+        }
+
+        if (iter == end || !is_digit(*iter))
+            return false;
+
+        // Clamp the exponent to something which can not overflow but is still well outside the range of a double
+        int explicit_exponent = 0;
+        for ( ; iter != end && is_digit(*iter); ++iter)
+        {
+            if (explicit_exponent < 100000)
+                explicit_exponent = explicit_exponent * 10 + (*iter - '0');
+        }
+        exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+    }
+
+    if (iter != end)
+        return false;
+
+    if (is_integer && !truncated)
+    {
+        if (!negative)
+        {
+            // Values from 2^63..2^64-1 are not considered an error. We can store the bits properly, but the onus is on the
+            // user to know the particular key was in the overflow range.
+            out.is_integer = true;
+            out.integer    = static_cast<std::int64_t>(mantissa);
+            return true;
+        }
+        else if (mantissa == 0)
+        {
+            out.is_integer = true;
+            out.integer    = 0;
+            return true;
+        }
+        else if (mantissa - 1 <= std::uint64_t(std::numeric_limits<std::int64_t>::max()))
+        {
+            out.is_integer = true;
+            out.integer    = -static_cast<std::int64_t>(mantissa - 1) - 1;
+            return true;
+        }
+        // else: too small for an int64_t -- treat it as a decimal
+    }
+
+    out.is_integer = false;
+    if (mantissa == 0 && !truncated)
+    {
+        out.decimal = negative ? -0.0 : 0.0;
+        return true;
+    }
+    else if (!truncated && decode_decimal_exact(mantissa, exponent, out.decimal))
+    {
+        if (negative)
+            out.decimal = -out.decimal;
+        return true;
+    }
+    else
+    {
+        return decode_decimal_fallback(text, out.decimal);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Encoding                                                                                                           //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/** The text of every number from 0 to 99, with a leading 0 for those under 10. **/
+static const char digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/** The smallest value with `idx + 1` digits is at \c digit_thresholds[idx] (except for 0, which has 1 digit). **/
+static const std::uint64_t digit_thresholds[] =
+{
+    0U,
+    10U,
+    100U,
+    1000U,
+    10000U,
+    100000U,
+    1000000U,
+    10000000U,
+    100000000U,
+    1000000000U,
+    10000000000U,
+    100000000000U,
+    1000000000000U,
+    10000000000000U,
+    100000000000000U,
+    1000000000000000U,
+    10000000000000000U,
+    100000000000000000U,
+    1000000000000000000U,
+    10000000000000000000U,
+};
+
+/** Count the decimal digits of \a value. **/
+static int count_digits(std::uint64_t value)
+{
+#if defined(__GNUC__)
+    // 1233 / 4096 is a little more than log10(2), so the bit length gives the number of digits or one fewer
+    int guess = ((64 - __builtin_clzll(value | 1)) * 1233) >> 12;
+    return guess + (value >= digit_thresholds[guess]);
+#else
+    int digits = 1;
+    while (digits < 20 && value >= digit_thresholds[digits])
+        ++digits;
+    return digits;
+#endif
+}
+
+char* encode_integer(std::int64_t value, char* out)
+{
+    std::uint64_t magnitude = static_cast<std::uint64_t>(value);
+    if (value < 0)
+    {
+        *out++ = '-';
+        magnitude = 0 - magnitude;
+    }
+
+    // Fill in the digits from the end, two at a time
+    char* end  = out + count_digits(magnitude);
+    char* iter = end;
+    while (magnitude >= 100)
+    {
+        std::size_t pair = std::size_t(magnitude % 100) * 2;
+        magnitude /= 100;
+        iter -= 2;
+        std::memcpy(iter, digit_pairs + pair, 2);
+    }
+    if (magnitude >= 10)
+        std::memcpy(iter - 2, digit_pairs + magnitude * 2, 2);
+    else
+        iter[-1] = char('0' + magnitude);
+    return end;
+}
+
+namespace
+{
+
+/** A floating-point number `f * 2^e` with a 64-bit significand, the "do-it-yourself floating point" of Grisu. **/
+struct diy_fp
+{
+    std::uint64_t f;
+    int           e;
+};
+
+/** A normalized power of 10, where `10^k` is about `f * 2^e`. **/
+struct cached_power
+{
+    std::uint64_t f;
+    int           e;
+    int           k;
+};
+
+}
+
+/** `x - y` for \a x and \a y with the same exponent, where `x.f >= y.f`. **/
+static diy_fp diy_sub(const diy_fp& x, const diy_fp& y)
+{
+    return { x.f - y.f, x.e };
+}
+
+/** `x * y`, rounded to the nearest 64-bit significand. **/
+static diy_fp diy_mul(const diy_fp& x, const diy_fp& y)
+{
+    const std::uint64_t low_mask = 0xffffffffU;
+
+    std::uint64_t x_lo = x.f & low_mask;
+    std::uint64_t x_hi = x.f >> 32;
+    std::uint64_t y_lo = y.f & low_mask;
+    std::uint64_t y_hi = y.f >> 32;
+
+    std::uint64_t p0 = x_lo * y_lo;
+    std::uint64_t p1 = x_lo * y_hi;
+    std::uint64_t p2 = x_hi * y_lo;
+    std::uint64_t p3 = x_hi * y_hi;
+
+    // The middle 64 bits of the product, plus half of the lowest to round
+    std::uint64_t mid = (p0 >> 32) + (p1 & low_mask) + (p2 & low_mask) + (std::uint64_t(1) << 31);
+
+    return { p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32), x.e + y.e + 64 };
+}
+
+/** Shift \a x so the highest bit of its significand is set. **/
+static diy_fp diy_normalize(diy_fp x)
+{
+    while (!(x.f >> 63))
+    {
+        x.f <<= 1;
+        --x.e;
+    }
+    return x;
+}
+
+/** Get \a value as a normalized \c diy_fp \a v, along with the normalized boundaries \a minus and \a plus halfway to
+ *  the neighboring doubles. Any number strictly between the boundaries is closer to \a value than to any other double.
+ *  The boundaries have the same exponent as \a v.
+**/
+static void compute_boundaries(double value, diy_fp& v, diy_fp& minus, diy_fp& plus)
+{
+    const int           significand_bits = 52;
+    const int           exponent_bias    = 1023 + significand_bits;
+    const std::uint64_t hidden_bit       = std::uint64_t(1) << significand_bits;
+
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof bits);
+    std::uint64_t biased_exponent = (bits >> significand_bits) & 0x7ff;
+    std::uint64_t fraction        = bits & (hidden_bit - 1);
+
+    diy_fp raw = biased_exponent == 0
+               ? diy_fp{ fraction, 1 - exponent_bias }
+               : diy_fp{ fraction + hidden_bit, int(biased_exponent) - exponent_bias };
+
+    // At a power of 2, the next lower double is half as far away as the next higher one
+    bool lower_is_closer = fraction == 0 && biased_exponent > 1;
+
+    diy_fp raw_plus  = { 2 * raw.f + 1, raw.e - 1 };
+    diy_fp raw_minus = lower_is_closer ? diy_fp{ 4 * raw.f - 1, raw.e - 2 } : diy_fp{ 2 * raw.f - 1, raw.e - 1 };
+
+    plus  = diy_normalize(raw_plus);
+    minus = { raw_minus.f << (raw_minus.e - plus.e), plus.e };
+    v     = diy_normalize(raw);
+}
+
+/** The range the binary exponent of a scaled number must be in for digit generation (see \c grisu2_digit_gen). **/
+static const int grisu_alpha = -60;
+static const int grisu_gamma = -32;
+
+/** Normalized powers of 10 from `10^-300` to `10^324` in steps of 8, which is enough to bring any double into
+ *  `[grisu_alpha, grisu_gamma]`.
+**/
+static const cached_power cached_powers[] =
+{
+    { 0xAB70FE17C79AC6CA, -1060, -300 },
+    { 0xFF77B1FCBEBCDC4F, -1034, -292 },
+    { 0xBE5691EF416BD60C, -1007, -284 },
+    { 0x8DD01FAD907FFC3C,  -980, -276 },
+    { 0xD3515C2831559A83,  -954, -268 },
+    { 0x9D71AC8FADA6C9B5,  -927, -260 },
+    { 0xEA9C227723EE8BCB,  -901, -252 },
+    { 0xAECC49914078536D,  -874, -244 },
+    { 0x823C12795DB6CE57,  -847, -236 },
+    { 0xC21094364DFB5637,  -821, -228 },
+    { 0x9096EA6F3848984F,  -794, -220 },
+    { 0xD77485CB25823AC7,  -768, -212 },
+    { 0xA086CFCD97BF97F4,  -741, -204 },
+    { 0xEF340A98172AACE5,  -715, -196 },
+    { 0xB23867FB2A35B28E,  -688, -188 },
+    { 0x84C8D4DFD2C63F3B,  -661, -180 },
+    { 0xC5DD44271AD3CDBA,  -635, -172 },
+    { 0x936B9FCEBB25C996,  -608, -164 },
+    { 0xDBAC6C247D62A584,  -582, -156 },
+    { 0xA3AB66580D5FDAF6,  -555, -148 },
+    { 0xF3E2F893DEC3F126,  -529, -140 },
+    { 0xB5B5ADA8AAFF80B8,  -502, -132 },
+    { 0x87625F056C7C4A8B,  -475, -124 },
+    { 0xC9BCFF6034C13053,  -449, -116 },
+    { 0x964E858C91BA2655,  -422, -108 },
+    { 0xDFF9772470297EBD,  -396, -100 },
+    { 0xA6DFBD9FB8E5B88F,  -369,  -92 },
+    { 0xF8A95FCF88747D94,  -343,  -84 },
+    { 0xB94470938FA89BCF,  -316,  -76 },
+    { 0x8A08F0F8BF0F156B,  -289,  -68 },
+    { 0xCDB02555653131B6,  -263,  -60 },
+    { 0x993FE2C6D07B7FAC,  -236,  -52 },
+    { 0xE45C10C42A2B3B06,  -210,  -44 },
+    { 0xAA242499697392D3,  -183,  -36 },
+    { 0xFD87B5F28300CA0E,  -157,  -28 },
+    { 0xBCE5086492111AEB,  -130,  -20 },
+    { 0x8CBCCC096F5088CC,  -103,  -12 },
+    { 0xD1B71758E219652C,   -77,   -4 },
+    { 0x9C40000000000000,   -50,    4 },
+    { 0xE8D4A51000000000,   -24,   12 },
+    { 0xAD78EBC5AC620000,     3,   20 },
+    { 0x813F3978F8940984,    30,   28 },
+    { 0xC097CE7BC90715B3,    56,   36 },
+    { 0x8F7E32CE7BEA5C70,    83,   44 },
+    { 0xD5D238A4ABE98068,   109,   52 },
+    { 0x9F4F2726179A2245,   136,   60 },
+    { 0xED63A231D4C4FB27,   162,   68 },
+    { 0xB0DE65388CC8ADA8,   189,   76 },
+    { 0x83C7088E1AAB65DB,   216,   84 },
+    { 0xC45D1DF942711D9A,   242,   92 },
+    { 0x924D692CA61BE758,   269,  100 },
+    { 0xDA01EE641A708DEA,   295,  108 },
+    { 0xA26DA3999AEF774A,   322,  116 },
+    { 0xF209787BB47D6B85,   348,  124 },
+    { 0xB454E4A179DD1877,   375,  132 },
+    { 0x865B86925B9BC5C2,   402,  140 },
+    { 0xC83553C5C8965D3D,   428,  148 },
+    { 0x952AB45CFA97A0B3,   455,  156 },
+    { 0xDE469FBD99A05FE3,   481,  164 },
+    { 0xA59BC234DB398C25,   508,  172 },
+    { 0xF6C69A72A3989F5C,   534,  180 },
+    { 0xB7DCBF5354E9BECE,   561,  188 },
+    { 0x88FCF317F22241E2,   588,  196 },
+    { 0xCC20CE9BD35C78A5,   614,  204 },
+    { 0x98165AF37B2153DF,   641,  212 },
+    { 0xE2A0B5DC971F303A,   667,  220 },
+    { 0xA8D9D1535CE3B396,   694,  228 },
+    { 0xFB9B7CD9A4A7443C,   720,  236 },
+    { 0xBB764C4CA7A44410,   747,  244 },
+    { 0x8BAB8EEFB6409C1A,   774,  252 },
+    { 0xD01FEF10A657842C,   800,  260 },
+    { 0x9B10A4E5E9913129,   827,  268 },
+    { 0xE7109BFBA19C0C9D,   853,  276 },
+    { 0xAC2820D9623BF429,   880,  284 },
+    { 0x80444B5E7AA7CF85,   907,  292 },
+    { 0xBF21E44003ACDD2D,   933,  300 },
+    { 0x8E679C2F5E44FF8F,   960,  308 },
+    { 0xD433179D9C8CB841,   986,  316 },
+    { 0x9E19DB92B4E31BA9,  1013,  324 },
+};
+
+static const int cached_powers_min_k  = -300;
+static const int cached_powers_k_step = 8;
+
+/** Find the cached power `c = 10^k` such that `grisu_alpha <= c.e + e + 64 <= grisu_gamma`. **/
+static const cached_power& cached_power_for_binary_exponent(int e)
+{
+    // 78913 / 2^18 is a little more than log10(2), so this is ceil((grisu_alpha - e - 1) * log10(2))
+    int f = grisu_alpha - e - 1;
+    int k = (f * 78913) / (1 << 18) + (f > 0);
+    int index = (-cached_powers_min_k + k + (cached_powers_k_step - 1)) / cached_powers_k_step;
+    return cached_powers[index];
+}
+
+/** Get the largest power of 10 which is at most \a n (which must be positive) and the number of digits of \a n. **/
+static int find_largest_pow10(std::uint32_t n, std::uint32_t& pow10)
+{
+    static const std::uint32_t powers[] =
+    {
+        1U, 10U, 100U, 1000U, 10000U, 100000U, 1000000U, 10000000U, 100000000U, 1000000000U,
+    };
+
+    int digits = 10;
+    while (digits > 1 && n < powers[digits - 1])
+        --digits;
+    pow10 = powers[digits - 1];
+    return digits;
+}
+
+/** Move the last digit of \a buffer down towards the scaled value while that keeps it inside of the boundaries and
+ *  brings it closer to the value. \a dist is the distance from the upper boundary to the value, \a delta the distance
+ *  between the boundaries, \a rest the distance from the upper boundary to the digits and \a ten_k the size of a step
+ *  of the last digit.
+**/
+static void grisu2_round(char*         buffer,
+                         int           length,
+                         std::uint64_t dist,
+                         std::uint64_t delta,
+                         std::uint64_t rest,
+                         std::uint64_t ten_k
+                        )
+{
+    while (  rest < dist
+          && delta - rest >= ten_k
+          && (rest + ten_k < dist || dist - rest > rest + ten_k - dist)
+          )
+    {
+        --buffer[length - 1];
+        rest += ten_k;
+    }
+}
+
+/** Generate the shortest digits of a number between \a minus and \a plus (which have an exponent in
+ *  `[grisu_alpha, grisu_gamma]`) as close as possible to \a w. The digits times `10^decimal_exponent` is the number.
+**/
+static void grisu2_digit_gen(char*         buffer,
+                             int&          length,
+                             int&          decimal_exponent,
+                             const diy_fp& minus,
+                             const diy_fp& w,
+                             const diy_fp& plus
+                            )
+{
+    std::uint64_t delta = diy_sub(plus, minus).f;
+    std::uint64_t dist  = diy_sub(plus, w).f;
+
+    // Split plus into an integral part p1 and a fractional part p2, where one is 1 at the exponent of plus
+    const diy_fp one = { std::uint64_t(1) << -plus.e, plus.e };
+
+    std::uint32_t p1 = std::uint32_t(plus.f >> -one.e);
+    std::uint64_t p2 = plus.f & (one.f - 1);
+
+    std::uint32_t pow10;
+    int n = find_largest_pow10(p1, pow10);
+
+    // Digits of the integral part
+    while (n > 0)
+    {
+        std::uint32_t digit = p1 / pow10;
+        p1 %= pow10;
+        buffer[length++] = char('0' + digit);
+        --n;
+
+        std::uint64_t rest = (std::uint64_t(p1) << -one.e) + p2;
+        if (rest <= delta)
+        {
+            decimal_exponent += n;
+            grisu2_round(buffer, length, dist, delta, rest, std::uint64_t(pow10) << -one.e);
+            return;
+        }
+        pow10 /= 10;
+    }
+
+    // Digits of the fractional part
+    int m = 0;
+    while (true)
+    {
+        p2 *= 10;
+        buffer[length++] = char('0' + (p2 >> -one.e));
+        p2 &= one.f - 1;
+        ++m;
+
+        delta *= 10;
+        dist  *= 10;
+        if (p2 <= delta)
+            break;
+    }
+    decimal_exponent -= m;
+    grisu2_round(buffer, length, dist, delta, p2, one.f);
+}
+
+/** Write the digits of the positive, finite \a value to \a buffer, where the digits times `10^decimal_exponent` is the
+ *  value.
+**/
+static void grisu2(char* buffer, int& length, int& decimal_exponent, double value)
+{
+    diy_fp v, minus, plus;
+    compute_boundaries(value, v, minus, plus);
+
+    const cached_power& cached = cached_power_for_binary_exponent(plus.e);
+    const diy_fp        c_k    = { cached.f, cached.e };
+
+    diy_fp w       = diy_mul(v,     c_k);
+    diy_fp w_minus = diy_mul(minus, c_k);
+    diy_fp w_plus  = diy_mul(plus,  c_k);
+
+    // The multiplications may be off by up to 1 ulp, so narrow the boundaries to stay inside of the real ones
+    diy_fp scaled_minus = { w_minus.f + 1, w_minus.e };
+    diy_fp scaled_plus  = { w_plus.f - 1,  w_plus.e };
+
+    length           = 0;
+    decimal_exponent = -cached.k;
+    grisu2_digit_gen(buffer, length, decimal_exponent, scaled_minus, w, scaled_plus);
+}
+
+/** Write the exponent \a e as a sign and at least two digits, like \c printf. **/
+static char* append_exponent(char* out, int e)
+{
+    if (e < 0)
+    {
+        *out++ = '-';
+        e = -e;
+    }
+    else
+    {
+        *out++ = '+';
+    }
+
+    if (e >= 100)
+    {
+        *out++ = char('0' + e / 100);
+        e %= 100;
+    }
+    *out++ = char('0' + e / 10);
+    *out++ = char('0' + e % 10);
+    return out;
+}
+
+/** Numbers with the decimal point at a position in `(min_plain_point, max_plain_point]` are written without an
+ *  exponent.
+**/
+static const int min_plain_point = -4;
+static const int max_plain_point = 15;
+
+/** Format the \a length digits at \a buffer, which are the number times `10^decimal_exponent`, in place.
+ *
+ *  \returns The end of the formatted text.
+**/
+static char* format_digits(char* buffer, int length, int decimal_exponent)
+{
+    // The decimal point goes after the first point digits
+    int point = length + decimal_exponent;
+
+    if (length <= point && point <= max_plain_point)
+    {
+        // 1234e3 -> 1234000.0
+        std::memset(buffer + length, '0', std::size_t(point - length));
+        buffer[point]     = '.';
+        buffer[point + 1] = '0';
+        return buffer + point + 2;
+    }
+    else if (0 < point && point <= max_plain_point)
+    {
+        // 1234e-2 -> 12.34
+        std::memmove(buffer + point + 1, buffer + point, std::size_t(length - point));
+        buffer[point] = '.';
+        return buffer + length + 1;
+    }
+    else if (min_plain_point < point && point <= 0)
+    {
+        // 1234e-6 -> 0.001234
+        std::memmove(buffer + 2 - point, buffer, std::size_t(length));
+        buffer[0] = '0';
+        buffer[1] = '.';
+        std::memset(buffer + 2, '0', std::size_t(-point));
+        return buffer + 2 - point + length;
+    }
+    else
+    {
+        if (length == 1)
+        {
+            // 1e30
+            ++buffer;
+        }
+        else
+        {
+            // 1234e30 -> 1.234e+33
+            std::memmove(buffer + 2, buffer + 1, std::size_t(length - 1));
+            buffer[1] = '.';
+            buffer += length + 1;
+        }
+        *buffer++ = 'e';
+        return append_exponent(buffer, point - 1);
+    }
+}
+
+char* encode_decimal(double value, char* out)
+{
+    if (std::signbit(value))
+    {
+        *out++ = '-';
+        value = -value;
+    }
+
+    if (value == 0.0)
+    {
+        *out++ = '0';
+        *out++ = '.';
+        *out++ = '0';
+        return out;
+    }
+
+    int length, decimal_exponent;
+    grisu2(out, length, decimal_exponent, value);
+    return format_digits(out, length, decimal_exponent);
+}
+
+}
+}
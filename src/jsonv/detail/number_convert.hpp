@@ -0,0 +1,80 @@
+/** \file jsonv/detail/number_convert.hpp
+ *  Conversion between JSON number tokens and integers and doubles, independent of the global locale. The C functions
+ *  (\c strtod, \c printf and friends) respect the global locale, so a program running in a locale with \c ',' as the
+ *  decimal separator would fail to parse \c "1.5" or write \c "1,5". They also require a null-terminated buffer, which
+ *  a token is not. Integers and the encoding of doubles never go through the C library, and neither does decoding of
+ *  doubles in the common case. Decimals with too many digits or too large an exponent for the fast path are decoded
+ *  by \c strtod_l with a \c "C" locale from a null-terminated copy, or by a stream imbued with the classic locale
+ *  where \c strtod_l is not available.
+ *
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#ifndef __JSONV_DETAIL_NUMBER_CONVERT_HPP_INCLUDED__
+#define __JSONV_DETAIL_NUMBER_CONVERT_HPP_INCLUDED__
+
+#include <jsonv/config.hpp>
+#include <jsonv/string_view.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace jsonv
+{
+namespace detail
+{
+
+/** The result of \c decode_number. **/
+struct decoded_number
+{
+    /** Was the input an integer? If \c true, the value is in \c integer; otherwise, it is in \c decimal. **/
+    bool         is_integer;
+    std::int64_t integer;
+    double       decimal;
+};
+
+/** Decode the number token \a text, which should look like `-?[0-9]+(\.[0-9]+)?([eE][+-]?[0-9]+)?` (this is what
+ *  \c match_number accepts). Leading zeros are allowed.
+ *
+ *  Input without a fraction or exponent is an integer. Values in the range `[2^63, 2^64)` are stored with the bits of
+ *  the unsigned value, which is how they have always been treated. Integers that do not fit in 64 bits at all become
+ *  decimals. Decimals are correctly rounded to the nearest \c double.
+ *
+ *  \returns \c true if \a text was a number; \c false if it was malformed (in which case \a out is unspecified).
+**/
+bool decode_number(string_view text, decoded_number& out);
+
+/** The most characters \c encode_integer will write. **/
+constexpr std::size_t max_encoded_integer_size = 20;
+
+/** Write the decimal text of \a value to \a out, which must have room for \c max_encoded_integer_size characters. An
+ *  integer decoded from the range `[2^63, 2^64)` (see \c decode_number) is negative, so it is written as negative.
+ *
+ *  \returns The end of the written text.
+**/
+char* encode_integer(std::int64_t value, char* out);
+
+/** The most characters \c encode_decimal will write. **/
+constexpr std::size_t max_encoded_decimal_size = 32;
+
+/** Write the text of the finite \a value to \a out, which must have room for \c max_encoded_decimal_size characters.
+ *  The text is the shortest which \c decode_number turns back into exactly \a value. This uses the Grisu2 algorithm
+ *  from Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers," which finds the
+ *  shortest for nearly all values. The few it misses are very close to halfway between two doubles, and get up to 17
+ *  significant digits instead (which still decode correctly). It always has a \c '.' or an exponent,
+ *  so it is decoded as a decimal and not an integer: \c 2.0 is written as \c "2.0", \c 1e100 as \c "1e+100" and
+ *  \c 0.1 as \c "0.1".
+ *
+ *  \returns The end of the written text.
+**/
+char* encode_decimal(double value, char* out);
+
+}
+}
+
+#endif/*__JSONV_DETAIL_NUMBER_CONVERT_HPP_INCLUDED__*/
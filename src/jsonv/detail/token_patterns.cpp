@@ -9,6 +9,7 @@
  *  \author Travis Gockel (travis@gockelhut.com)
 **/
 #include <jsonv/detail/token_patterns.hpp>
+#include <jsonv/detail/char_scan.hpp>
 
 #include <algorithm>
 #include <cassert>
@@ -320,33 +321,45 @@ static match_result match_number(const char* begin, const char* end, token_kind&
     return match_result::complete;
 }
 
-static match_result match_string(const char* begin, const char* end, token_kind& kind, std::size_t& length)
+static match_result match_string(const char*  begin,
+                                 const char*  end,
+                                 token_kind&  kind,
+                                 std::size_t& length,
+                                 bool&        verbatim
+                                )
 {
     assert(*begin == '\"');
     
     kind = token_kind::string;
-    length = 1;
     
-    while (true)
+    // Fast path: look for the end of the string while checking that everything in it is plain ASCII
+    const char* pos = scan_string_unusual(begin + 1, end);
+    if (pos != end && *pos == '\"')
     {
-        if (begin + length == end)
-            return match_result::unmatched;
-        
-        if (begin[length] == '\"')
+        verbatim = true;
+        length   = std::size_t(pos - begin) + 1;
+        return match_result::complete;
+    }
+    
+    verbatim = false;
+    for ( ; /* inline */; pos += 2)
+    {
+        pos = scan_string_special(pos, end);
+        if (pos == end)
         {
-            ++length;
-            return match_result::complete;
+            length = std::size_t(end - begin);
+            return match_result::unmatched;
         }
-        else if (begin[length] == '\\')
+        else if (*pos == '\"')
         {
-            if (begin + length + 1 == end)
-                return match_result::unmatched;
-            else
-                length += 2;
+            length = std::size_t(pos - begin) + 1;
+            return match_result::complete;
         }
-        else
+        // *pos == '\\' -- skip over the escaped character
+        else if (pos + 1 == end)
         {
-            ++length;
+            length = std::size_t(pos - begin);
+            return match_result::unmatched;
         }
     }
 }
@@ -386,20 +399,8 @@ static match_result match_simple_string(const char* begin, const char* end, toke
 
 static match_result match_whitespace(const char* begin, const char* end, token_kind& kind, std::size_t& length)
 {
-    kind = token_kind::whitespace;
-    for (length = 0; begin != end; ++length, ++begin)
-    {
-        switch (*begin)
-        {
-        case ' ':
-        case '\t':
-        case '\r':
-        case '\n':
-            continue;
-        default:
-            return match_result::complete;
-        }
-    }
+    kind   = token_kind::whitespace;
+    length = std::size_t(scan_whitespace(begin, end) - begin);
     return match_result::complete;
 }
 
@@ -444,6 +445,19 @@ static match_result match_comment(const char* begin, const char* end, token_kind
 
 match_result attempt_match(const char* begin, const char* end, token_kind& kind, std::size_t& length)
 {
+    bool verbatim;
+    return attempt_match(begin, end, kind, length, verbatim);
+}
+
+match_result attempt_match(const char*  begin,
+                           const char*  end,
+                           token_kind&  kind,
+                           std::size_t& length,
+                           bool&        verbatim
+                          )
+{
+    verbatim = false;
+
     auto result = [&] (match_result r, token_kind kind_, std::size_t length_)
                   {
                       kind = kind_;
@@ -480,7 +494,7 @@ match_result attempt_match(const char* begin, const char* end, token_kind& kind,
     case '9':
         return match_number(begin, end, kind, length);
     case '\"':
-        return match_string(begin, end, kind, length);
+        return match_string(begin, end, kind, length, verbatim);
     case ' ':
     case '\t':
     case '\n':
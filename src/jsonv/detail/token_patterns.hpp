@@ -42,6 +42,19 @@ match_result attempt_match(const char*  begin,
                            std::size_t& length
                           );
 
+/** Like \c attempt_match, but also report if the match is a \c token_kind::string which can be used verbatim.
+ *  
+ *  \param[out] verbatim Set to \c true if the matched token is a string with no escape sequences, control characters
+ *                       or non-ASCII characters. The contents between the quotes are then exactly what decoding the
+ *                       string would produce, regardless of the \c parse_options::encoding.
+**/
+match_result attempt_match(const char*  begin,
+                           const char*  end,
+                           token_kind&  kind,
+                           std::size_t& length,
+                           bool&        verbatim
+                          );
+
 enum class path_match_result : char
 {
     simple_object = '.',
@@ -0,0 +1,113 @@
+/** \file
+ *  
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv/document_reader.hpp>
+#include <jsonv/tokenizer.hpp>
+
+#include "detail.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace jsonv
+{
+
+document_reader::document_reader(tokenizer& input, const parse_options& options) :
+        _input(input),
+        _options(parse_options(options).failure_mode(parse_options::on_error::fail_immediately)),
+        _count(0),
+        _failed(false)
+{ }
+
+document_reader::document_reader(std::istream& input, const parse_options& options) :
+        _owned_input(new tokenizer(input)),
+        _input(*_owned_input),
+        _options(parse_options(options).failure_mode(parse_options::on_error::fail_immediately)),
+        _count(0),
+        _failed(false)
+{ }
+
+document_reader::document_reader(string_view input, const parse_options& options) :
+        _owned_input(new tokenizer(input)),
+        _input(*_owned_input),
+        _options(parse_options(options).failure_mode(parse_options::on_error::fail_immediately)),
+        _count(0),
+        _failed(false)
+{ }
+
+document_reader::~document_reader() noexcept = default;
+
+document_reader::size_type document_reader::count() const
+{
+    return _count;
+}
+
+bool document_reader::next(value& out)
+{
+    if (_failed)
+        throw std::logic_error("Cannot read from a document_reader after it has thrown a parse_error");
+    
+    auto problem = [this] (const std::string& message)
+                   {
+                       _failed = true;
+                       const tokenizer::token& token = _input.current();
+                       tokenizer::size_type line, column, character;
+                       _input.locate(token.text.data(), line, column, character);
+                       std::ostringstream os;
+                       os << message << ": \"" << token.text << "\"";
+                       throw parse_error({ parse_error::problem(line, column, character, os.str()) }, null);
+                   };
+    
+    // Find the start of the next document
+    while (true)
+    {
+        if (!_input.next())
+            return false;
+        
+        const tokenizer::token& token = _input.current();
+        if (token.kind == token_kind::whitespace)
+        {
+            continue;
+        }
+        else if (token.kind == token_kind::comment)
+        {
+            if (!_options.comments())
+                problem("JSON comment is not allowed");
+            continue;
+        }
+        // At the end of input, we might have a few nulls -- this is expected for string literals, so ignore them.
+        else if (std::all_of(token.text.begin(), token.text.end(), [] (char c) { return c == '\0'; }))
+        {
+            continue;
+        }
+        else
+        {
+            break;
+        }
+    }
+    
+    if (  _options.require_document()
+       && _input.current().kind != token_kind::array_begin
+       && _input.current().kind != token_kind::object_begin
+       )
+    {
+        problem("JSON requires the root of a payload to be an array or object");
+    }
+    
+    // If parse_current throws, the input is left somewhere inside of the bad document
+    _failed = true;
+    out = parse_current(_input, _options);
+    _failed = false;
+    ++_count;
+    return true;
+}
+
+}
@@ -11,10 +11,17 @@
 **/
 #include <jsonv/encode.hpp>
 #include <jsonv/value.hpp>
+#include <jsonv/detail/number_convert.hpp>
 
+#include "char_convert.hpp"
 #include "detail.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace jsonv
 {
@@ -74,7 +81,7 @@ void encoder::encode(const value& source)
         write_object_end();
         break;
     case kind::string:
-        write_string(source.as_string());
+        write_string(source.as_string_view());
         break;
     }
 }
@@ -90,6 +97,11 @@ ostream_encoder::ostream_encoder(std::ostream& output) :
 
 ostream_encoder::~ostream_encoder() noexcept = default;
 
+void ostream_encoder::ensure_ascii(bool value)
+{
+    _ensure_ascii = value;
+}
+
 void ostream_encoder::write_array_begin()
 {
     _output << '[';
@@ -113,15 +125,23 @@ void ostream_encoder::write_boolean(bool value)
 void ostream_encoder::write_decimal(double value)
 {
     if (std::isfinite(value))
-        _output << value;
+    {
+        char  text[detail::max_encoded_decimal_size];
+        char* end = detail::encode_decimal(value, text);
+        _output.write(text, end - text);
+    }
     else
+    {
         // non-finite values do not have valid JSON representations, so put it as null
         write_null();
+    }
 }
 
 void ostream_encoder::write_integer(std::int64_t value)
 {
-    _output << value;
+    char  text[detail::max_encoded_integer_size];
+    char* end = detail::encode_integer(value, text);
+    _output.write(text, end - text);
 }
 
 void ostream_encoder::write_null()
@@ -277,4 +297,453 @@ void ostream_pretty_encoder::write_string(string_view value)
     ostream_encoder::write_string(value);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// buffer_encoder                                                                                                     //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/** The capacity an owned buffer starts with when it first needs to grow. **/
+static const std::size_t buffer_encoder_initial_capacity = 256;
+
+buffer_encoder::buffer_encoder() :
+        _data(nullptr),
+        _size(0),
+        _capacity(0),
+        _fixed(false),
+        _ensure_ascii(true)
+{ }
+
+buffer_encoder::buffer_encoder(char* data, size_type capacity) :
+        _data(data),
+        _size(0),
+        _capacity(capacity),
+        _fixed(true),
+        _ensure_ascii(true)
+{ }
+
+buffer_encoder::~buffer_encoder() noexcept = default;
+
+void buffer_encoder::ensure_ascii(bool value)
+{
+    _ensure_ascii = value;
+}
+
+string_view buffer_encoder::encode(const value& source)
+{
+    encoder::encode(source);
+    return text();
+}
+
+string_view buffer_encoder::text() const
+{
+    return string_view(_data, _size);
+}
+
+buffer_encoder::size_type buffer_encoder::size() const
+{
+    return _size;
+}
+
+buffer_encoder::size_type buffer_encoder::capacity() const
+{
+    return _capacity;
+}
+
+void buffer_encoder::clear()
+{
+    _size = 0;
+}
+
+void buffer_encoder::reserve(size_type capacity)
+{
+    if (capacity <= _capacity)
+        return;
+    
+    if (_fixed)
+        throw std::length_error("buffer_encoder output does not fit in its buffer of "
+                                + std::to_string(_capacity) + " characters"
+                               );
+    
+    std::unique_ptr<char[]> storage(new char[capacity]);
+    if (_size > 0)
+        std::memcpy(storage.get(), _data, _size);
+    _owned    = std::move(storage);
+    _data     = _owned.get();
+    _capacity = capacity;
+}
+
+void buffer_encoder::append(const char* text, size_type size)
+{
+    if (_capacity - _size < size)
+        reserve(std::max({ _capacity * 2, _size + size, buffer_encoder_initial_capacity }));
+    std::memcpy(_data + _size, text, size);
+    _size += size;
+}
+
+void buffer_encoder::append(char c)
+{
+    if (_size == _capacity)
+        reserve(std::max(_capacity * 2, buffer_encoder_initial_capacity));
+    _data[_size++] = c;
+}
+
+void buffer_encoder::write_array_begin()
+{
+    append('[');
+}
+
+void buffer_encoder::write_array_end()
+{
+    append(']');
+}
+
+void buffer_encoder::write_array_delimiter()
+{
+    append(',');
+}
+
+void buffer_encoder::write_boolean(bool value)
+{
+    if (value)
+        append("true", 4);
+    else
+        append("false", 5);
+}
+
+void buffer_encoder::write_decimal(double value)
+{
+    if (std::isfinite(value))
+    {
+        char  text[detail::max_encoded_decimal_size];
+        char* end = detail::encode_decimal(value, text);
+        append(text, size_type(end - text));
+    }
+    else
+    {
+        // non-finite values do not have valid JSON representations, so put it as null
+        write_null();
+    }
+}
+
+void buffer_encoder::write_integer(std::int64_t value)
+{
+    char  text[detail::max_encoded_integer_size];
+    char* end = detail::encode_integer(value, text);
+    append(text, size_type(end - text));
+}
+
+void buffer_encoder::write_null()
+{
+    append("null", 4);
+}
+
+void buffer_encoder::write_object_begin()
+{
+    append('{');
+}
+
+void buffer_encoder::write_object_end()
+{
+    append('}');
+}
+
+void buffer_encoder::write_object_delimiter()
+{
+    append(',');
+}
+
+void buffer_encoder::write_object_key(string_view key)
+{
+    write_string(key);
+    append(':');
+}
+
+void buffer_encoder::write_string(string_view value)
+{
+    append('"');
+    detail::string_encode([] (void* context, const char* text, std::size_t size)
+                          {
+                              static_cast<buffer_encoder*>(context)->append(text, size);
+                          },
+                          this,
+                          value,
+                          _ensure_ascii
+                         );
+    append('"');
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// chunked_encoder                                                                                                    //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/** Is \a c a byte in the middle of a UTF-8 sequence? **/
+static bool is_utf8_continuation(char c)
+{
+    return (static_cast<unsigned char>(c) & 0xc0) == 0x80;
+}
+
+class chunked_encoder::impl
+{
+public:
+    explicit impl(const value& source, size_type chunk_size) :
+            _source(source),
+            _chunk_size(std::max(chunk_size, size_type(1))),
+            _ensure_ascii(true),
+            _emitted(0),
+            _started(false),
+            _string_active(false),
+            _string_is_key(false),
+            _key_value(nullptr)
+    { }
+    
+    void ensure_ascii(bool value)
+    {
+        _ensure_ascii = value;
+        _writer.ensure_ascii(value);
+    }
+    
+    size_type chunk_size() const
+    {
+        return _chunk_size;
+    }
+    
+    bool next_chunk(std::string& out)
+    {
+        out.clear();
+        while (out.size() < _chunk_size)
+        {
+            string_view pending = _writer.text();
+            if (_emitted < pending.size())
+            {
+                size_type count = std::min(pending.size() - _emitted, _chunk_size - out.size());
+                out.append(pending.data() + _emitted, count);
+                _emitted += count;
+            }
+            else
+            {
+                _writer.clear();
+                _emitted = 0;
+                if (!step())
+                    break;
+            }
+        }
+        return !out.empty();
+    }
+    
+    bool done() const
+    {
+        return _started && _stack.empty() && !_string_active && _emitted == _writer.size();
+    }
+    
+private:
+    /** Gives the protected members of \c buffer_encoder to \c impl, which writes a token at a time. **/
+    class token_writer :
+            public buffer_encoder
+    {
+    public:
+        using buffer_encoder::append;
+        using buffer_encoder::write_boolean;
+        using buffer_encoder::write_decimal;
+        using buffer_encoder::write_integer;
+        using buffer_encoder::write_null;
+    };
+    
+    /** An array or object which is being encoded. **/
+    struct frame
+    {
+        const value* container;
+        size_type    index;     //!< The number of elements which have been started
+    };
+    
+private:
+    /** Write the next piece of output to \c _writer.
+     *  
+     *  \returns \c false if there is nothing left to write.
+    **/
+    bool step()
+    {
+        if (_string_active)
+        {
+            write_string_slice();
+            return true;
+        }
+        
+        if (!_started)
+        {
+            _started = true;
+            begin_value(_source);
+            return true;
+        }
+        
+        if (_stack.empty())
+            return false;
+        
+        frame& top = _stack.back();
+        if (top.container->kind() == kind::array)
+        {
+            if (top.index == top.container->size())
+            {
+                _writer.append(']');
+                _stack.pop_back();
+            }
+            else
+            {
+                if (top.index > 0)
+                    _writer.append(',');
+                const value& element = (*top.container)[top.index++];
+                begin_value(element);
+            }
+        }
+        else
+        {
+            value::const_object_iterator& position = _object_positions.back();
+            if (position == top.container->end_object())
+            {
+                _writer.append('}');
+                _stack.pop_back();
+                _object_positions.pop_back();
+            }
+            else
+            {
+                if (top.index++ > 0)
+                    _writer.append(',');
+                const value::object_value_type& entry = *position;
+                ++position;
+                _key_value = &entry.second;
+                begin_string(entry.first, true);
+            }
+        }
+        return true;
+    }
+    
+    /** Write the start of \a source. Scalars are written whole, while containers and strings are continued by \c step.
+    **/
+    void begin_value(const value& source)
+    {
+        switch (source.kind())
+        {
+        case kind::array:
+            _writer.append('[');
+            _stack.push_back({ &source, 0 });
+            break;
+        case kind::boolean:
+            _writer.write_boolean(source.as_boolean());
+            break;
+        case kind::decimal:
+            _writer.write_decimal(source.as_decimal());
+            break;
+        case kind::integer:
+            _writer.write_integer(source.as_integer());
+            break;
+        case kind::null:
+            _writer.write_null();
+            break;
+        case kind::object:
+            _writer.append('{');
+            _stack.push_back({ &source, 0 });
+            _object_positions.push_back(source.begin_object());
+            break;
+        case kind::string:
+            begin_string(source.as_string_view(), false);
+            break;
+        }
+    }
+    
+    void begin_string(string_view text, bool is_key)
+    {
+        _writer.append('"');
+        _string_rest   = text;
+        _string_is_key = is_key;
+        _string_active = true;
+        write_string_slice();
+    }
+    
+    /** Escape about a chunk of the string in progress. A slice never ends in the middle of a UTF-8 sequence, since the
+     *  pieces would be escaped differently than the whole sequence. Sequences are at most 6 bytes long, so if more
+     *  continuation bytes than that come before the cut, they are not part of a valid sequence and are cut anywhere.
+    **/
+    void write_string_slice()
+    {
+        size_type cut      = std::min(_string_rest.size(), _chunk_size);
+        size_type boundary = cut;
+        for (int backoff = 0; backoff < 5 && boundary > 0 && boundary < _string_rest.size(); ++backoff)
+        {
+            if (!is_utf8_continuation(_string_rest[boundary]))
+                break;
+            --boundary;
+        }
+        if (boundary == 0)
+        {
+            // The slice is shorter than the sequence it starts with, so take the whole sequence
+            for (int extra = 0; extra < 5 && cut < _string_rest.size(); ++extra, ++cut)
+                if (!is_utf8_continuation(_string_rest[cut]))
+                    break;
+        }
+        else if (boundary == _string_rest.size() || !is_utf8_continuation(_string_rest[boundary]))
+        {
+            cut = boundary;
+        }
+        
+        detail::string_encode([] (void* context, const char* text, std::size_t size)
+                              {
+                                  static_cast<token_writer*>(context)->append(text, size);
+                              },
+                              &_writer,
+                              _string_rest.substr(0, cut),
+                              _ensure_ascii
+                             );
+        _string_rest.remove_prefix(cut);
+        
+        if (_string_rest.empty())
+        {
+            _writer.append('"');
+            _string_active = false;
+            if (_string_is_key)
+            {
+                _writer.append(':');
+                begin_value(*_key_value);
+            }
+        }
+    }
+    
+private:
+    const value&                              _source;
+    size_type                                 _chunk_size;
+    bool                                      _ensure_ascii;
+    token_writer                              _writer;           //!< Output which has not been given out yet
+    size_type                                 _emitted;          //!< The part of \c _writer given out already
+    bool                                      _started;
+    std::vector<frame>                        _stack;
+    std::vector<value::const_object_iterator> _object_positions; //!< The next entry of each object on \c _stack
+    bool                                      _string_active;    //!< Is a string only partly written?
+    bool                                      _string_is_key;
+    string_view                               _string_rest;      //!< The part of the string left to write
+    const value*                              _key_value;        //!< The value of the key being written
+};
+
+chunked_encoder::chunked_encoder(const value& source, size_type chunk_size) :
+        _impl(new impl(source, chunk_size))
+{ }
+
+chunked_encoder::~chunked_encoder() noexcept = default;
+
+void chunked_encoder::ensure_ascii(bool value)
+{
+    _impl->ensure_ascii(value);
+}
+
+chunked_encoder::size_type chunked_encoder::chunk_size() const
+{
+    return _impl->chunk_size();
+}
+
+bool chunked_encoder::next_chunk(std::string& out)
+{
+    return _impl->next_chunk(out);
+}
+
+bool chunked_encoder::done() const
+{
+    return _impl->done();
+}
+
 }
@@ -0,0 +1,710 @@
+/** \file
+ *  
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv/lazy.hpp>
+#include <jsonv/tokenizer.hpp>
+#include <jsonv/detail/fallthrough.hpp>
+#include <jsonv/detail/number_convert.hpp>
+
+#include "char_convert.hpp"
+#include "detail.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace jsonv
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// lazy_index                                                                                                         //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+
+struct JSONV_LOCAL lazy_index
+{
+    enum class node_kind : unsigned char
+    {
+        null,
+        boolean,
+        number,
+        string,
+        array,
+        object,
+    };
+    
+    /** An entry for a value or key in the input. The children of an array or object directly follow it; in an object,
+     *  they alternate between key and value.
+    **/
+    struct node
+    {
+        std::uint32_t offset;   //!< Where the text of the value starts in the input
+        std::uint32_t length;   //!< The length of the text; for an array or object, this includes the closing bracket
+        std::uint32_t next;     //!< The node after this one and everything inside of it
+        std::uint32_t count;    //!< The number of elements of an array or members of an object
+        std::uint32_t children; //!< For an array, where the nodes of its elements start in \c lazy_index::children
+        node_kind     kind;
+        bool          verbatim; //!< See \c tokenizer::token::verbatim
+    };
+    
+    /** The node of the value of each key of an object, built the first time a key is looked up in a large object. **/
+    using key_map = std::unordered_map<std::string, std::uint32_t>;
+    
+    enum class expect : unsigned char
+    {
+        value_or_end,
+        value,
+        separator_or_end,
+        key_or_end,
+        key,
+        delimiter,
+    };
+    
+    struct frame
+    {
+        std::uint32_t node;
+        expect        next;
+        std::uint32_t first_element; //!< Where the elements of an array start in the pending elements of \c build
+    };
+    
+    string_view                input;
+    parse_options              options;
+    string_decode_fn           string_decode;
+    std::vector<node>          nodes;
+    std::vector<std::uint32_t> children; //!< The nodes of the elements of each array, one array after another
+    
+    // What has been decoded so far. Each node has a slot in decoded, which is set once to point at its entry in one of
+    // the deques. The deques are only touched with cache_lock held, but a set slot can be read without taking it.
+    mutable std::mutex                          cache_lock;
+    mutable std::deque<std::string>             strings;
+    mutable std::deque<decoded_number>          numbers;
+    mutable std::deque<key_map>                 key_maps;
+    std::unique_ptr<std::atomic<const void*>[]> decoded;
+    
+    explicit lazy_index(string_view input, const parse_options& options) :
+            input(input),
+            options(options),
+            string_decode(get_string_decoder(options.string_encoding()))
+    {
+        if (input.size() >= std::numeric_limits<std::uint32_t>::max())
+            throw std::length_error("lazy_document does not support input of 4 GiB or more");
+        build();
+        decoded.reset(new std::atomic<const void*>[nodes.size()]());
+    }
+    
+    string_view text(std::uint32_t idx) const
+    {
+        return string_view(input.data() + nodes[idx].offset, nodes[idx].length);
+    }
+    
+    /** Get the contents of the string at \a idx, without the quotes. **/
+    string_view string_source(std::uint32_t idx) const
+    {
+        string_view source = text(idx);
+        source.remove_prefix(1);
+        source.remove_suffix(1);
+        return source;
+    }
+    
+    /** Get the cached decoding of the node at \a idx from \a store, calling \a decode to make it the first time it is
+     *  asked for. Decoding happens without the lock held, so threads decoding different nodes do not wait on each
+     *  other. If two threads decode the same node at once, the first one to finish wins.
+    **/
+    template <typename T, typename FDecode>
+    const T& cached(std::uint32_t idx, std::deque<T>& store, const FDecode& decode) const
+    {
+        if (const void* found = decoded[idx].load(std::memory_order_acquire))
+            return *static_cast<const T*>(found);
+        
+        T value = decode();
+        std::lock_guard<std::mutex> lock(cache_lock);
+        if (const void* found = decoded[idx].load(std::memory_order_relaxed))
+            return *static_cast<const T*>(found);
+        store.push_back(std::move(value));
+        decoded[idx].store(&store.back(), std::memory_order_release);
+        return store.back();
+    }
+    
+    /** Get the decoded contents of the string at \a idx. The result stays valid for as long as the document. **/
+    const std::string& cached_string(std::uint32_t idx) const
+    {
+        return cached(idx, strings, [&] { return decode_string(idx); });
+    }
+    
+    /** Get the number at \a idx, converting it the first time it is asked for. **/
+    decoded_number cached_number(std::uint32_t idx) const
+    {
+        return cached(idx, numbers, [&] { return decode_number(idx); });
+    }
+    
+    /** Get the \c key_map of the object at \a idx, building it the first time it is asked for. **/
+    const key_map& cached_keys(std::uint32_t idx) const
+    {
+        return cached(idx,
+                      key_maps,
+                      [&]
+                      {
+                          key_map keys(nodes[idx].count);
+                          // emplace keeps the first of duplicate keys, like a linear search would find
+                          for (std::uint32_t key = idx + 1; key < nodes[idx].next; key = nodes[key + 1].next)
+                              keys.emplace(decode_string(key), key + 1);
+                          return keys;
+                      }
+                     );
+    }
+    
+    std::string decode_string(std::uint32_t idx) const
+    {
+        if (nodes[idx].verbatim)
+            return std::string(string_source(idx));
+        
+        try
+        {
+            return string_decode(string_source(idx));
+        }
+        catch (const decode_error& err)
+        {
+            problem(input.data() + nodes[idx].offset, std::string("Error decoding string:") + err.what());
+        }
+    }
+    
+    decoded_number decode_number(std::uint32_t idx) const
+    {
+        decoded_number out;
+        if (!detail::decode_number(text(idx), out))
+            problem(input.data() + nodes[idx].offset,
+                    "Could not extract number from \"" + std::string(text(idx)) + "\""
+                   );
+        return out;
+    }
+    
+    /** Throw a \c parse_error for \a message at \a position in the input. **/
+    [[noreturn]]
+    void problem(const char* position, const std::string& message) const
+    {
+        tokenizer locator(input);
+        tokenizer::size_type line, column, character;
+        locator.locate(position, line, column, character);
+        throw parse_error({ parse_error::problem(line, column, character, message) }, null);
+    }
+    
+    void build();
+};
+
+void lazy_index::build()
+{
+    tokenizer tokens(input);
+    std::vector<frame> frames;
+    std::vector<std::uint32_t> pending_elements; //!< The elements of the open arrays, which go to children on close
+    bool root_finished = false;
+    
+    auto fail = [&] (const std::string& message)
+                {
+                    string_view text = tokens.current().text;
+                    problem(text.data(), message + ": \"" + std::string(text) + "\"");
+                };
+    
+    auto add_node = [&] (node_kind kind)
+                    {
+                        const tokenizer::token& token = tokens.current();
+                        auto idx = std::uint32_t(nodes.size());
+                        nodes.push_back({ std::uint32_t(token.text.data() - input.data()),
+                                          std::uint32_t(token.text.size()),
+                                          idx + 1,
+                                          0,
+                                          0,
+                                          kind,
+                                          token.verbatim
+                                        }
+                                       );
+                        return idx;
+                    };
+    
+    // Add the value which starts at the current token to the structure being built
+    auto add_value = [&] ()
+                     {
+                         const tokenizer::token& token = tokens.current();
+                         bool is_structure = token.kind == token_kind::array_begin
+                                          || token.kind == token_kind::object_begin;
+                         
+                         if (frames.empty())
+                         {
+                             if (options.require_document() && !is_structure)
+                                 fail("JSON requires the root of a payload to be an array or object");
+                             if (!is_structure)
+                                 root_finished = true;
+                         }
+                         else
+                         {
+                             frame& parent = frames.back();
+                             if (nodes[parent.node].kind == node_kind::array)
+                             {
+                                 ++nodes[parent.node].count;
+                                 pending_elements.push_back(std::uint32_t(nodes.size()));
+                             }
+                             parent.next = expect::separator_or_end;
+                         }
+                         
+                         switch (token.kind)
+                         {
+                         case token_kind::array_begin:
+                         case token_kind::object_begin:
+                             if (frames.size() + 1 == options.max_structure_depth())
+                                 fail("Structure depth reached maximum of " + std::to_string(frames.size() + 1));
+                             if (token.kind == token_kind::array_begin)
+                                 frames.push_back({ add_node(node_kind::array),
+                                                    expect::value_or_end,
+                                                    std::uint32_t(pending_elements.size())
+                                                  }
+                                                 );
+                             else
+                                 frames.push_back({ add_node(node_kind::object), expect::key_or_end, 0 });
+                             break;
+                         case token_kind::null:
+                             if (token.text != "null")
+                                 fail("Failed to match \"null\"");
+                             add_node(node_kind::null);
+                             break;
+                         case token_kind::boolean:
+                             if (token.text != "true" && token.text != "false")
+                                 fail("Failed to match a boolean");
+                             add_node(node_kind::boolean);
+                             break;
+                         case token_kind::number:
+                             if (  options.number_encoding() == parse_options::numbers::strict
+                                && token.text.size() > 1U
+                                && token.text[0] == '0'
+                                )
+                             {
+                                 fail("Numbers cannot start with a leading '0'");
+                             }
+                             add_node(node_kind::number);
+                             break;
+                         case token_kind::string:
+                             add_node(node_kind::string);
+                             break;
+                         default:
+                             fail("Encountered invalid token");
+                         }
+                     };
+    
+    while (tokens.next())
+    {
+        const tokenizer::token& token = tokens.current();
+        if (token.kind == token_kind::whitespace)
+        {
+            continue;
+        }
+        else if (token.kind == token_kind::comment)
+        {
+            if (!options.comments())
+                fail("JSON comment is not allowed");
+            continue;
+        }
+        else if ((token.kind & token_kind::parse_error_indicator) == token_kind::parse_error_indicator)
+        {
+            fail("Encountered invalid token");
+        }
+        
+        if (frames.empty())
+        {
+            if (!root_finished)
+            {
+                add_value();
+                continue;
+            }
+            else if (!options.complete_parse())
+            {
+                break;
+            }
+            // At the end of input, we might have a few nulls -- this is expected for string literals, so ignore them.
+            else if (std::any_of(token.text.begin(), token.text.end(), [] (char c) { return c != '\0'; }))
+            {
+                fail("Found non-trivial data after final token");
+            }
+            continue;
+        }
+        
+        frame&     top       = frames.back();
+        bool       is_object = nodes[top.node].kind == node_kind::object;
+        token_kind end_kind  = is_object ? token_kind::object_end : token_kind::array_end;
+        if (token.kind == end_kind)
+        {
+            switch (top.next)
+            {
+            case expect::value:
+                if (is_object)
+                    fail("Unexpected end: incomplete value for key");
+                JSONV_FALLTHROUGH();
+            case expect::key:
+                if (options.comma_policy() != parse_options::commas::allow_trailing)
+                    fail(is_object ? "Trailing comma at end of object" : "Array contained a trailing comma");
+                break;
+            case expect::delimiter:
+                fail("Unexpected end: missing ':' for key");
+            default:
+                break;
+            }
+            
+            node& closed  = nodes[top.node];
+            closed.next   = std::uint32_t(nodes.size());
+            closed.length = std::uint32_t(token.text.data() + 1 - input.data()) - closed.offset;
+            if (!is_object)
+            {
+                closed.children = std::uint32_t(children.size());
+                children.insert(children.end(), pending_elements.begin() + top.first_element, pending_elements.end());
+                pending_elements.resize(top.first_element);
+            }
+            frames.pop_back();
+            if (frames.empty())
+                root_finished = true;
+            continue;
+        }
+        
+        switch (top.next)
+        {
+        case expect::value_or_end:
+        case expect::value:
+            add_value();
+            break;
+        case expect::separator_or_end:
+            if (token.kind != token_kind::separator)
+                fail("Invalid token while searching for the next value");
+            top.next = is_object ? expect::key : expect::value;
+            break;
+        case expect::key_or_end:
+        case expect::key:
+            if (token.kind != token_kind::string)
+                fail("Expecting a key");
+            add_node(node_kind::string);
+            ++nodes[top.node].count;
+            top.next = expect::delimiter;
+            break;
+        case expect::delimiter:
+            if (token.kind != token_kind::object_key_delimiter)
+                fail("Invalid key-value delimiter...expecting ':' after key");
+            top.next = expect::value;
+            break;
+        }
+    }
+    
+    if (!root_finished)
+    {
+        // report the problem at the end of the input
+        problem(input.data() + input.size(), nodes.empty() ? "No input" : "Unexpected end inside of structure");
+    }
+}
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// lazy_value                                                                                                         //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+using node_kind = detail::lazy_index::node_kind;
+
+/** Objects with up to this many members are searched by comparing each key, which is faster than building a
+ *  \c lazy_index::key_map for them.
+**/
+static const std::uint32_t linear_find_max = 8;
+
+lazy_value::lazy_value(const detail::lazy_index* index, std::uint32_t node) :
+        _index(index),
+        _node(node)
+{ }
+
+jsonv::kind lazy_value::kind() const
+{
+    switch (_index->nodes[_node].kind)
+    {
+    case node_kind::null:    return jsonv::kind::null;
+    case node_kind::boolean: return jsonv::kind::boolean;
+    case node_kind::number:
+        return _index->cached_number(_node).is_integer ? jsonv::kind::integer : jsonv::kind::decimal;
+    case node_kind::string:  return jsonv::kind::string;
+    case node_kind::array:   return jsonv::kind::array;
+    case node_kind::object:  return jsonv::kind::object;
+    default:                 return jsonv::kind::null;
+    }
+}
+
+bool lazy_value::is_null() const
+{
+    return _index->nodes[_node].kind == node_kind::null;
+}
+
+lazy_value::size_type lazy_value::size() const
+{
+    switch (_index->nodes[_node].kind)
+    {
+    case node_kind::array:
+    case node_kind::object:
+        return _index->nodes[_node].count;
+    case node_kind::string:
+        return as_string().size();
+    default:
+        check_type({ jsonv::kind::object, jsonv::kind::array, jsonv::kind::string }, kind());
+        return 0;
+    }
+}
+
+lazy_value lazy_value::at(size_type idx) const
+{
+    check_type(jsonv::kind::array, kind());
+    if (idx >= size())
+        throw std::out_of_range("Index " + std::to_string(idx) + " is out of range for array of size "
+                                + std::to_string(size())
+                               );
+    
+    return lazy_value(_index, _index->children[_index->nodes[_node].children + idx]);
+}
+
+std::uint32_t lazy_value::find(string_view key) const
+{
+    check_type(jsonv::kind::object, kind());
+    
+    const auto& nodes = _index->nodes;
+    if (nodes[_node].count > linear_find_max)
+    {
+        const detail::lazy_index::key_map& keys = _index->cached_keys(_node);
+        auto iter = keys.find(std::string(key));
+        return iter == keys.end() ? 0 : iter->second;
+    }
+    
+    for (std::uint32_t node = _node + 1; node < nodes[_node].next; node = nodes[node + 1].next)
+    {
+        // keys without escapes can be compared without decoding them
+        if (nodes[node].verbatim ? _index->string_source(node) == key : _index->cached_string(node) == key)
+            return node + 1;
+    }
+    return 0;
+}
+
+lazy_value lazy_value::at(string_view key) const
+{
+    std::uint32_t node = find(key);
+    if (!node)
+        throw std::out_of_range("Key \"" + std::string(key) + "\" does not exist in object");
+    return lazy_value(_index, node);
+}
+
+lazy_value::size_type lazy_value::count(string_view key) const
+{
+    return find(key) ? 1 : 0;
+}
+
+lazy_value lazy_value::at_path(const path& p) const
+{
+    return walk_path(lazy_value(*this),
+                     p.begin(),
+                     p.end(),
+                     [&p] (const path_element& elem, const lazy_value& current)
+                     {
+                         throw std::out_of_range(to_string(elem) + " does not exist on " + std::string(current.text())
+                                                 + " (full path: " + to_string(p) + ")"
+                                                );
+                     }
+                    );
+}
+
+lazy_value lazy_value::at_path(string_view p) const
+{
+    return at_path(path::create(p));
+}
+
+lazy_value lazy_value::at_path(size_type p) const
+{
+    return at_path(path({ path_element(p) }));
+}
+
+lazy_value::size_type lazy_value::count_path(const path& p) const
+{
+    try
+    {
+        at_path(p);
+        return 1;
+    }
+    catch (const std::out_of_range&)
+    {
+        return 0;
+    }
+    catch (const kind_error&)
+    {
+        return 0;
+    }
+}
+
+lazy_value::size_type lazy_value::count_path(string_view p) const
+{
+    return count_path(path::create(p));
+}
+
+lazy_value::size_type lazy_value::count_path(size_type p) const
+{
+    return count_path(path({ path_element(p) }));
+}
+
+const std::string& lazy_value::as_string() const
+{
+    check_type(jsonv::kind::string, kind());
+    return _index->cached_string(_node);
+}
+
+std::int64_t lazy_value::as_integer() const
+{
+    if (_index->nodes[_node].kind == node_kind::number)
+    {
+        detail::decoded_number number = _index->cached_number(_node);
+        if (number.is_integer)
+            return number.integer;
+    }
+    check_type(jsonv::kind::integer, kind());
+    return 0;
+}
+
+double lazy_value::as_decimal() const
+{
+    if (_index->nodes[_node].kind == node_kind::number)
+    {
+        detail::decoded_number number = _index->cached_number(_node);
+        return number.is_integer ? double(number.integer) : number.decimal;
+    }
+    check_type(jsonv::kind::decimal, kind());
+    return 0.0;
+}
+
+bool lazy_value::as_boolean() const
+{
+    check_type(jsonv::kind::boolean, kind());
+    return text()[0] == 't';
+}
+
+string_view lazy_value::text() const
+{
+    return _index->text(_node);
+}
+
+value lazy_value::materialize() const
+{
+    return parse(text(), parse_options(_index->options).require_document(false).complete_parse(true));
+}
+
+lazy_value::array_iterator lazy_value::begin_array() const
+{
+    check_type(jsonv::kind::array, kind());
+    return array_iterator(_index, _node + 1);
+}
+
+lazy_value::array_iterator lazy_value::end_array() const
+{
+    check_type(jsonv::kind::array, kind());
+    return array_iterator(_index, _index->nodes[_node].next);
+}
+
+lazy_value::object_iterator lazy_value::begin_object() const
+{
+    check_type(jsonv::kind::object, kind());
+    return object_iterator(_index, _node + 1);
+}
+
+lazy_value::object_iterator lazy_value::end_object() const
+{
+    check_type(jsonv::kind::object, kind());
+    return object_iterator(_index, _index->nodes[_node].next);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// lazy_value::array_iterator                                                                                         //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+lazy_value::array_iterator::array_iterator(const detail::lazy_index* index, std::uint32_t node) :
+        _index(index),
+        _node(node)
+{ }
+
+lazy_value lazy_value::array_iterator::operator*() const
+{
+    return lazy_value(_index, _node);
+}
+
+lazy_value::array_iterator& lazy_value::array_iterator::operator++()
+{
+    _node = _index->nodes[_node].next;
+    return *this;
+}
+
+lazy_value::array_iterator lazy_value::array_iterator::operator++(int)
+{
+    array_iterator out = *this;
+    ++*this;
+    return out;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// lazy_value::object_iterator                                                                                        //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+lazy_value::object_iterator::object_iterator(const detail::lazy_index* index, std::uint32_t node) :
+        _index(index),
+        _node(node)
+{ }
+
+std::pair<std::string, lazy_value> lazy_value::object_iterator::operator*() const
+{
+    return { _index->cached_string(_node), lazy_value(_index, _node + 1) };
+}
+
+lazy_value::object_iterator& lazy_value::object_iterator::operator++()
+{
+    _node = _index->nodes[_node + 1].next;
+    return *this;
+}
+
+lazy_value::object_iterator lazy_value::object_iterator::operator++(int)
+{
+    object_iterator out = *this;
+    ++*this;
+    return out;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// lazy_document                                                                                                      //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+lazy_document::lazy_document(string_view input, const parse_options& options) :
+        _index(new detail::lazy_index(input, options))
+{ }
+
+lazy_document::lazy_document(lazy_document&&) noexcept = default;
+
+lazy_document& lazy_document::operator=(lazy_document&&) noexcept = default;
+
+lazy_document::~lazy_document() noexcept = default;
+
+lazy_value lazy_document::root() const
+{
+    return lazy_value(_index.get(), 0);
+}
+
+lazy_document::size_type lazy_document::index_size() const
+{
+    return _index->nodes.size();
+}
+
+}
@@ -0,0 +1,168 @@
+/** \file
+ *
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv/mapped_file.hpp>
+
+#include <cerrno>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <utility>
+
+#if __cplusplus >= 201703L || defined __has_include
+#   if __has_include(<sys/mman.h>)
+#       define JSONV_HAS_MMAP 1
+#       include <fcntl.h>
+#       include <sys/mman.h>
+#       include <sys/stat.h>
+#       include <unistd.h>
+#   else
+#       define JSONV_HAS_MMAP 0
+#   endif
+#else
+#   define JSONV_HAS_MMAP 0
+#endif
+
+namespace jsonv
+{
+
+#if JSONV_HAS_MMAP
+
+/** Closes a file descriptor when it goes out of scope. The mapping stays valid after the descriptor is closed. **/
+class scoped_fd
+{
+public:
+    explicit scoped_fd(int fd) :
+            _fd(fd)
+    { }
+    
+    scoped_fd(const scoped_fd&) = delete;
+    scoped_fd& operator=(const scoped_fd&) = delete;
+    
+    ~scoped_fd() noexcept
+    {
+        if (_fd >= 0)
+            ::close(_fd);
+    }
+    
+    int get() const
+    {
+        return _fd;
+    }
+    
+private:
+    int _fd;
+};
+
+static std::system_error system_error_for(const std::string& operation, const std::string& path)
+{
+    return std::system_error(errno, std::system_category(), operation + " \"" + path + "\"");
+}
+
+mapped_file::mapped_file(const std::string& path) :
+        _data(""),
+        _size(0),
+        _mapped(false)
+{
+    scoped_fd fd(::open(path.c_str(), O_RDONLY));
+    if (fd.get() < 0)
+        throw system_error_for("Could not open", path);
+    
+    struct ::stat info;
+    if (::fstat(fd.get(), &info) != 0)
+        throw system_error_for("Could not stat", path);
+    
+    // mmap refuses to map nothing, but an empty file is fine
+    if (info.st_size == 0)
+        return;
+    
+    void* mapping = ::mmap(nullptr, size_type(info.st_size), PROT_READ, MAP_PRIVATE, fd.get(), 0);
+    if (mapping == MAP_FAILED)
+        throw system_error_for("Could not map", path);
+    
+    // The tokenizer reads front to back, so let the system read ahead aggressively and drop pages behind it
+    ::madvise(mapping, size_type(info.st_size), MADV_SEQUENTIAL);
+    
+    _data   = static_cast<const char*>(mapping);
+    _size   = size_type(info.st_size);
+    _mapped = true;
+}
+
+void mapped_file::unmap() noexcept
+{
+    if (_mapped)
+        ::munmap(const_cast<char*>(_data), _size);
+}
+
+#else
+
+mapped_file::mapped_file(const std::string& path) :
+        _data(""),
+        _size(0),
+        _mapped(false)
+{
+    std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+    if (!file)
+        throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory),
+                                "Could not open \"" + path + "\""
+                               );
+    
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    _copy = buffer.str();
+    _data = _copy.data();
+    _size = _copy.size();
+}
+
+void mapped_file::unmap() noexcept
+{ }
+
+#endif
+
+mapped_file::mapped_file(mapped_file&& source) noexcept :
+        _data(source._data),
+        _size(source._size),
+        _mapped(source._mapped),
+        _copy(std::move(source._copy))
+{
+    if (!_mapped && _size > 0)
+        _data = _copy.data();
+    
+    source._data   = "";
+    source._size   = 0;
+    source._mapped = false;
+}
+
+mapped_file& mapped_file::operator=(mapped_file&& source) noexcept
+{
+    if (this != &source)
+    {
+        unmap();
+        
+        _data   = source._data;
+        _size   = source._size;
+        _mapped = source._mapped;
+        _copy   = std::move(source._copy);
+        if (!_mapped && _size > 0)
+            _data = _copy.data();
+        
+        source._data   = "";
+        source._size   = 0;
+        source._mapped = false;
+    }
+    return *this;
+}
+
+mapped_file::~mapped_file() noexcept
+{
+    unmap();
+}
+
+}
@@ -0,0 +1,272 @@
+/** \file
+ *  
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv/ndjson.hpp>
+#include <jsonv/detail/scope_exit.hpp>
+
+#include "detail.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <istream>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace jsonv
+{
+
+/** The number of lines each thread parses in a batch of \c ndjson_reader::read_all. **/
+static const std::size_t lines_per_thread = 1024;
+
+/** Get the options to parse each line with. Lines read from a stream are copied into a buffer which is reused for the
+ *  next line, so strings can only be borrowed from lines of a \c string_view input.
+**/
+static parse_options line_options(const parse_options& options, bool input_is_stable)
+{
+    parse_options out(options);
+    out.complete_parse(true);
+    if (!input_is_stable)
+        out.borrow_strings(false);
+    return out;
+}
+
+static bool is_blank(string_view text)
+{
+    return std::all_of(text.begin(), text.end(), [] (char c) { return c == ' ' || c == '\t' || c == '\r'; });
+}
+
+/** Parse the \a text of a line with \a parser into \a out. The positions of problems are moved from the line to the
+ *  input, where the line is \a line and starts at \a offset.
+**/
+static void parse_line(detail::record_parser& parser,
+                       string_view            text,
+                       std::size_t            line,
+                       std::size_t            offset,
+                       ndjson_reader::record& out
+                      )
+{
+    out.line   = line;
+    out.result = parser.parse(text, out.problems);
+    for (parse_error::problem& p : out.problems)
+        p = parse_error::problem(line + p.line() - 1, p.column(), offset + p.character(), p.message());
+}
+
+ndjson_reader::ndjson_reader(std::istream& input, const parse_options& options) :
+        _stream(&input),
+        _position(0),
+        _line(0),
+        _options(line_options(options, false)),
+        _parser(new detail::record_parser(_options))
+{ }
+
+ndjson_reader::ndjson_reader(string_view input, const parse_options& options) :
+        _stream(nullptr),
+        _input(input),
+        _position(0),
+        _line(0),
+        _options(line_options(options, true)),
+        _parser(new detail::record_parser(_options))
+{ }
+
+ndjson_reader::~ndjson_reader() noexcept = default;
+
+bool ndjson_reader::next_line(string_view& text, size_type& line, size_type& offset)
+{
+    do
+    {
+        offset = _position;
+        if (_stream)
+        {
+            if (!std::getline(*_stream, _buffer))
+                return false;
+            _position += _buffer.size() + 1;
+            text = _buffer;
+        }
+        else
+        {
+            if (_position >= _input.size())
+                return false;
+            const char* begin = _input.data() + _position;
+            const void* end   = std::memchr(begin, '\n', _input.size() - _position);
+            text = string_view(begin,
+                               end ? size_type(static_cast<const char*>(end) - begin) : _input.size() - _position
+                              );
+            _position += text.size() + 1;
+        }
+        line = ++_line;
+    } while (is_blank(text));
+    
+    if (text.back() == '\r')
+        text.remove_suffix(1);
+    return true;
+}
+
+bool ndjson_reader::next(record& out)
+{
+    string_view text;
+    size_type   line, offset;
+    if (!next_line(text, line, offset))
+        return false;
+    
+    parse_line(*_parser, text, line, offset, out);
+    return true;
+}
+
+void ndjson_reader::read_all(const std::function<void (record&)>& on_record, size_type thread_count)
+{
+    if (thread_count == 0)
+        thread_count = std::max(1U, std::thread::hardware_concurrency());
+    
+    if (thread_count == 1)
+    {
+        record out;
+        while (next(out))
+            on_record(out);
+        return;
+    }
+    
+    struct pending_line
+    {
+        string_view text;
+        size_type   line;
+        size_type   offset;
+    };
+    
+    // Each thread gets its own parser, which is kept for every batch
+    std::vector<std::unique_ptr<detail::record_parser>> parsers;
+    for (size_type idx = 0; idx < thread_count; ++idx)
+        parsers.emplace_back(new detail::record_parser(_options));
+    
+    std::vector<pending_line>       lines;
+    std::deque<std::string>         storage; //!< Copies of lines read from a stream, which does not move them
+    std::vector<record>             records;
+    std::atomic<size_type>          next_index(0);
+    std::vector<std::exception_ptr> worker_errors(thread_count);
+    auto work = [&] (size_type worker)
+                {
+                    try
+                    {
+                        detail::record_parser& parser = *parsers[worker];
+                        for (size_type idx = next_index++; idx < lines.size(); idx = next_index++)
+                            parse_line(parser, lines[idx].text, lines[idx].line, lines[idx].offset, records[idx]);
+                    }
+                    catch (...)
+                    {
+                        worker_errors[worker] = std::current_exception();
+                    }
+                };
+    
+    // The same workers are used for every batch. Each batch has a new generation number, and the workers wait for the
+    // next one once they run out of lines. The batch is over when none of them are busy.
+    std::mutex              pool_lock;
+    std::condition_variable batch_started;
+    std::condition_variable batch_finished;
+    size_type               generation = 0;
+    size_type               busy       = 0;
+    bool                    done       = false;
+    
+    std::vector<std::thread> workers;
+    workers.reserve(thread_count - 1);
+    // Joined on the way out no matter what, since destroying a joinable std::thread calls std::terminate
+    auto join_workers = detail::on_scope_exit([&]
+                                              {
+                                                  {
+                                                      std::lock_guard<std::mutex> guard(pool_lock);
+                                                      done = true;
+                                                  }
+                                                  batch_started.notify_all();
+                                                  for (std::thread& worker : workers)
+                                                      worker.join();
+                                              }
+                                             );
+    for (size_type worker = 1; worker < thread_count; ++worker)
+    {
+        try
+        {
+            workers.emplace_back([&, worker]
+                                 {
+                                     size_type seen = 0;
+                                     while (true)
+                                     {
+                                         {
+                                             std::unique_lock<std::mutex> guard(pool_lock);
+                                             batch_started.wait(guard, [&] { return done || generation != seen; });
+                                             if (done)
+                                                 return;
+                                             seen = generation;
+                                         }
+                                         
+                                         work(worker);
+                                         
+                                         std::lock_guard<std::mutex> guard(pool_lock);
+                                         if (--busy == 0)
+                                             batch_finished.notify_one();
+                                     }
+                                 }
+                                );
+        }
+        catch (const std::system_error&)
+        {
+            // Out of threads -- the ones which did start (and this one) will get through all the lines
+            break;
+        }
+    }
+    
+    while (true)
+    {
+        lines.clear();
+        storage.clear();
+        pending_line current;
+        while (  lines.size() < thread_count * lines_per_thread
+              && next_line(current.text, current.line, current.offset)
+              )
+        {
+            if (_stream)
+            {
+                storage.emplace_back(current.text.data(), current.text.size());
+                current.text = storage.back();
+            }
+            lines.push_back(current);
+        }
+        if (lines.empty())
+            return;
+        
+        records.clear();
+        records.resize(lines.size());
+        next_index = 0;
+        {
+            std::lock_guard<std::mutex> guard(pool_lock);
+            ++generation;
+            busy = workers.size();
+        }
+        batch_started.notify_all();
+        
+        work(0);
+        
+        {
+            std::unique_lock<std::mutex> guard(pool_lock);
+            batch_finished.wait(guard, [&] { return busy == 0; });
+        }
+        for (const std::exception_ptr& error : worker_errors)
+            if (error)
+                std::rethrow_exception(error);
+        
+        for (record& out : records)
+            on_record(out);
+    }
+}
+
+}
@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <iterator>
 #include <stdexcept>
 #include <type_traits>
 
@@ -70,8 +71,16 @@ object_node_handle::mapped_type& object_node_handle::mapped() const
 value object()
 {
     value x;
-    x._data.object = new detail::object_impl;
-    x._kind = jsonv::kind::object;
+    x._fields.data.object = detail::object_impl::create(nullptr);
+    x._fields.kind = jsonv::kind::object;
+    return x;
+}
+
+value object(arena& region)
+{
+    value x;
+    x._fields.data.object = detail::object_impl::create(&region);
+    x._fields.kind = jsonv::kind::object;
     return x;
 }
 
@@ -89,28 +98,66 @@ value object(std::initializer_list<std::pair<std::wstring, value>> source)
     return x;
 }
 
+/** Expose \a impl before modifying it in the range [\a first, \a last). If \a impl was shared, the iterators point into
+ *  the node which is left to the other values, so they are moved to the same places in the copy. Keys are unique, so
+ *  the place of an iterator in the copy is found by looking up its key instead of walking to it.
+**/
+static void expose_range(detail::object_impl*&               impl,
+                         detail::object_impl::const_iterator& first,
+                         detail::object_impl::const_iterator& last
+                        )
+{
+    if (!impl->shared())
+    {
+        impl->expose();
+        return;
+    }
+    
+    detail::object_impl* copy = impl->clone();
+    auto same_place = [&] (detail::object_impl::const_iterator iter) -> detail::object_impl::const_iterator
+                      {
+                          if (iter == impl->_values.cend())
+                              return copy->_values.cend();
+                          else
+                              return copy->_values.find(iter->first);
+                      };
+    first = same_place(first);
+    last  = same_place(last);
+    detail::object_impl::release(impl);
+    impl = copy;
+    impl->expose();
+}
+
+static detail::object_impl::const_iterator expose_at(detail::object_impl*&              impl,
+                                                     detail::object_impl::const_iterator position
+                                                    )
+{
+    expose_range(impl, position, position);
+    return position;
+}
+
 value::object_iterator value::begin_object()
 {
     check_type(jsonv::kind::object, kind());
-    return object_iterator(_data.object->_values.begin());
+    return object_iterator(detail::expose(_fields.data.object)->_values.begin());
 }
 
 value::const_object_iterator value::begin_object() const
 {
     check_type(jsonv::kind::object, kind());
-    return const_object_iterator(_data.object->_values.begin());
+    return const_object_iterator(_fields.data.object->_values.begin());
 }
 
 value::object_iterator value::end_object()
 {
     check_type(jsonv::kind::object, kind());
-    return object_iterator(_data.object->_values.end());
+    return object_iterator(detail::expose(_fields.data.object)->_values.end());
 }
 
 value::const_object_iterator value::end_object() const
 {
     check_type(jsonv::kind::object, kind());
-    return const_object_iterator(_data.object->_values.end());
+    return const_object_iterator(_fields.data.object->_values.end());
 }
 
 value::object_view value::as_object() &
@@ -135,85 +182,89 @@ value::owning_object_view value::as_object() &&
 value& value::operator[](const std::string& key)
 {
     check_type(jsonv::kind::object, kind());
-    return _data.object->_values[key];
+    return detail::expose(_fields.data.object)->_values[key];
 }
 
 value& value::operator[](std::string&& key)
 {
     check_type(jsonv::kind::object, kind());
-    return _data.object->_values[std::move(key)];
+    return detail::expose(_fields.data.object)->_values[std::move(key)];
 }
 
 value& value::operator[](const std::wstring& key)
 {
     check_type(jsonv::kind::object, kind());
-    return _data.object->_values[detail::convert_to_narrow(key)];
+    return detail::expose(_fields.data.object)->_values[detail::convert_to_narrow(key)];
 }
 
 value& value::at(const std::string& key)
 {
     check_type(jsonv::kind::object, kind());
-    return _data.object->_values.at(key);
+    // check for the key first, so a failed lookup does not copy a shared object
+    if (_fields.data.object->_values.count(key) == 0)
+        throw std::out_of_range("Key \"" + key + "\" does not exist in object");
+    return detail::expose(_fields.data.object)->_values.at(key);
 }
 
 const value& value::at(const std::string& key) const
 {
     check_type(jsonv::kind::object, kind());
-    return _data.object->_values.at(key);
+    return _fields.data.object->_values.at(key);
 }
 
 value& value::at(const std::wstring& key)
 {
     check_type(jsonv::kind::object, kind());
-    return _data.object->_values.at(detail::convert_to_narrow(key));
+    return at(detail::convert_to_narrow(key));
 }
 
 const value& value::at(const std::wstring& key) const
 {
     check_type(jsonv::kind::object, kind());
-    return _data.object->_values.at(detail::convert_to_narrow(key));
+    return _fields.data.object->_values.at(detail::convert_to_narrow(key));
 }
 
 value::size_type value::count(const std::string& key) const
 {
     check_type(jsonv::kind::object, kind());
-    return _data.object->_values.count(key);
+    return _fields.data.object->_values.count(key);
 }
 
 value::size_type value::count(const std::wstring& key) const
 {
     check_type(jsonv::kind::object, kind());
-    return _data.object->_values.count(detail::convert_to_narrow(key));
+    return _fields.data.object->_values.count(detail::convert_to_narrow(key));
 }
 
 value::object_iterator value::find(const std::string& key)
 {
     check_type(jsonv::kind::object, kind());
-    return object_iterator(_data.object->_values.find(key));
+    return object_iterator(detail::expose(_fields.data.object)->_values.find(key));
 }
 
 value::object_iterator value::find(const std::wstring& key)
 {
     check_type(jsonv::kind::object, kind());
-    return object_iterator(_data.object->_values.find(detail::convert_to_narrow(key)));
+    return object_iterator(detail::expose(_fields.data.object)->_values.find(detail::convert_to_narrow(key)));
 }
 
 value::const_object_iterator value::find(const std::string& key) const
 {
     check_type(jsonv::kind::object, kind());
-    return const_object_iterator(_data.object->_values.find(key));
+    return const_object_iterator(_fields.data.object->_values.find(key));
 }
 
 value::const_object_iterator value::find(const std::wstring& key) const
 {
     check_type(jsonv::kind::object, kind());
-    return const_object_iterator(_data.object->_values.find(detail::convert_to_narrow(key)));
+    return const_object_iterator(_fields.data.object->_values.find(detail::convert_to_narrow(key)));
 }
 
 value::object_iterator value::insert(value::const_object_iterator hint, std::pair<std::string, value> pair)
 {
     check_type(jsonv::kind::object, kind());
-    return object_iterator(_data.object->_values.insert(hint._impl, std::move(pair)));
+    auto place = expose_at(_fields.data.object, hint._impl);
+    return object_iterator(_fields.data.object->_values.insert(place, std::move(pair)));
 }
 
 value::object_iterator value::insert(value::const_object_iterator hint, std::pair<std::wstring, value> pair)
@@ -225,22 +276,26 @@ value::object_iterator value::insert(value::const_object_iterator hint, std::pai
 std::pair<value::object_iterator, bool> value::insert(std::pair<std::string, value> pair)
 {
     check_type(jsonv::kind::object, kind());
-    auto ret = _data.object->_values.insert(pair);
+    auto ret = detail::expose(_fields.data.object)->_values.insert(std::move(pair));
     return { object_iterator(ret.first), ret.second };
 }
 
 std::pair<value::object_iterator, bool> value::insert(std::pair<std::wstring, value> pair)
 {
     check_type(jsonv::kind::object, kind());
-    auto ret = _data.object->_values.insert({ detail::convert_to_narrow(pair.first), std::move(pair.second) });
+    auto ret = detail::expose(_fields.data.object)->_values.insert({ detail::convert_to_narrow(pair.first),
+                                                              std::move(pair.second)
+                                                            }
+                                                           );
     return { object_iterator(ret.first), ret.second };
 }
 
 void value::insert(std::initializer_list<std::pair<std::string, value>> items)
 {
     check_type(jsonv::kind::object, kind());
+    auto& values = detail::unshare(_fields.data.object)->_values;
     for (auto& pair : items)
-         _data.object->_values.insert(std::move(pair));
+         values.insert(std::move(pair));
 }
 
 void value::insert(std::initializer_list<std::pair<std::wstring, value>> items)
@@ -256,7 +311,10 @@ value::object_insert_return_type value::insert(object_node_handle&& handle)
     if (handle.empty())
         return { end_object(), false };
 
-    auto insert_rc = _data.object->_values.insert({ std::move(handle.key()), std::move(handle.mapped()) });
+    auto insert_rc = detail::expose(_fields.data.object)->_values.insert({ std::move(handle.key()),
+                                                                    std::move(handle.mapped())
+                                                                  }
+                                                                 );
     return { const_object_iterator(insert_rc.first), insert_rc.second };
 }
 
@@ -266,8 +324,8 @@ value::object_iterator value::insert(const_object_iterator, object_node_handle&&
     if (handle.empty())
         return end_object();
 
-    auto place = _data.object->_values.find(handle.key());
-    if (place == _data.object->_values.end())
+    auto place = detail::expose(_fields.data.object)->_values.find(handle.key());
+    if (place == _fields.data.object->_values.end())
     {
         return insert({ std::move(handle.key()), std::move(handle.mapped()) }).first;
     }
@@ -280,25 +338,31 @@ value::object_iterator value::insert(const_object_iterator, object_node_handle&&
 value::size_type value::erase(const std::string& key)
 {
     check_type(jsonv::kind::object, kind());
-    return _data.object->_values.erase(key);
+    if (_fields.data.object->_values.count(key) == 0)
+        return 0;
+    return detail::unshare(_fields.data.object)->_values.erase(key);
 }
 
 value::size_type value::erase(const std::wstring& key)
 {
     check_type(jsonv::kind::object, kind());
-    return _data.object->_values.erase(detail::convert_to_narrow(key));
+    return erase(detail::convert_to_narrow(key));
 }
 
 value::object_iterator value::erase(const_object_iterator position)
 {
     check_type(jsonv::kind::object, kind());
-    return object_iterator(_data.object->_values.erase(position._impl));
+    auto place = expose_at(_fields.data.object, position._impl);
+    return object_iterator(_fields.data.object->_values.erase(place));
 }
 
 value::object_iterator value::erase(const_object_iterator first, const_object_iterator last)
 {
     check_type(jsonv::kind::object, kind());
-    return object_iterator(_data.object->_values.erase(first._impl, last._impl));
+    auto first_place = first._impl;
+    auto last_place  = last._impl;
+    expose_range(_fields.data.object, first_place, last_place);
+    return object_iterator(_fields.data.object->_values.erase(first_place, last_place));
 }
 
 template <typename TMap>
@@ -347,8 +411,9 @@ object_node_handle extract_impl(TMapImpl& impl, TIterator position, FCreate&& cr
 object_node_handle value::extract(const_object_iterator position)
 {
     check_type(jsonv::kind::object, kind());
-    return extract_impl(_data.object->_values,
-                        position._impl,
+    auto place = expose_at(_fields.data.object, position._impl);
+    return extract_impl(_fields.data.object->_values,
+                        place,
                         [] (std::string key, value x)
                         {
                             return object_node_handle(object_node_handle::purposeful_construction(),
@@ -22,14 +22,25 @@ namespace jsonv
 namespace detail
 {
 
+/** Keys are plain \c std::string instances owned by each member. They are not interned or shared between objects,
+ *  since \c value::object_value_type exposes them as \c std::pair<const std::string, value>, and a \c std::string
+ *  can not refer to storage it does not own. Short keys fit in the small-string buffer and do not allocate anyway.
+**/
 class JSONV_LOCAL object_impl :
         public cloneable<object_impl>
 {
 public:
-    using map_type       = std::map<std::string, jsonv::value>;
+    using map_type       = object_map;
     using iterator       = map_type::iterator;
     using const_iterator = map_type::const_iterator;
     
+public:
+    object_impl() = default;
+    
+    explicit object_impl(arena* region) :
+            _values(map_type::key_compare(), map_type::allocator_type(region))
+    { }
+    
 public:
     bool empty() const;
     
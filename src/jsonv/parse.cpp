@@ -10,15 +10,21 @@
 **/
 #include <jsonv/parse.hpp>
 #include <jsonv/array.hpp>
-#include <jsonv/encode.hpp>
+#include <jsonv/mapped_file.hpp>
 #include <jsonv/object.hpp>
 #include <jsonv/tokenizer.hpp>
+#include <jsonv/detail/scope_exit.hpp>
+#include <jsonv/detail/number_convert.hpp>
 
 #include "char_convert.hpp"
+#include "detail.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cctype>
+#include <cstdint>
 #include <cstdlib>
+#include <iterator>
 #include <istream>
 #include <set>
 #include <sstream>
@@ -237,6 +243,17 @@ parse_options& parse_options::comments(bool val)
     return *this;
 }
 
+bool parse_options::borrow_strings() const
+{
+    return _borrow_strings;
+}
+
+parse_options& parse_options::borrow_strings(bool val)
+{
+    _borrow_strings = val;
+    return *this;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // parsing internals                                                                                                  //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -252,9 +269,7 @@ struct JSONV_LOCAL parse_context
     parse_options    options;
     string_decode_fn string_decode;
     
-    size_type line;
-    size_type column;
-    size_type character;
+    size_type depth;
     
     bool                             successful;
     jsonv::parse_error::problem_list problems;
@@ -264,9 +279,7 @@ struct JSONV_LOCAL parse_context
             input(input),
             options(options),
             string_decode(get_string_decoder(options.string_encoding())),
-            line(0),
-            column(1),
-            character(0),
+            depth(0),
             successful(true),
             problems(),
             complete(false)
@@ -275,29 +288,17 @@ struct JSONV_LOCAL parse_context
     parse_context(const parse_context&) = delete;
     parse_context& operator=(const parse_context&) = delete;
     
+    /** Get ready to parse from the start of \c input again. **/
+    void reset()
+    {
+        depth      = 0;
+        successful = true;
+        problems.clear();
+        complete   = false;
+    }
+    
     bool next()
     {
-        if (!complete && line != 0)
-        {
-            character += current().text.size();
-            for (const char c : current().text)
-            {
-                if (c == '\n' || c == '\r')
-                {
-                    ++line;
-                    column = 1;
-                }
-                else
-                {
-                    ++column;
-                }
-            }
-        }
-        else
-        {
-            ++line;
-        }
-        
         if (input.next())
         {
             JSONV_DBG_NEXT("(" << input.current().text << " cxt:" << input.current().kind << ")");
@@ -328,6 +329,25 @@ struct JSONV_LOCAL parse_context
         return input.current();
     }
     
+    /** Called when the parser is about to descend into an array or object. If this would go past the
+     *  \c parse_options::max_structure_depth, a problem is reported and \c false is returned.
+    **/
+    bool enter_structure()
+    {
+        if (++depth == options.max_structure_depth())
+        {
+            parse_error("Structure depth reached maximum of ", depth);
+            --depth;
+            return false;
+        }
+        return true;
+    }
+    
+    void leave_structure()
+    {
+        --depth;
+    }
+    
     const token_kind& current_kind() const
     {
         return current().kind;
@@ -350,6 +370,9 @@ private:
         }
         catch (const std::logic_error&)
         { }
+        
+        size_type line, column, character;
+        input.locate(error_position(), line, column, character);
         jsonv::parse_error::problem problem(line, column, character, stream.str());
         if (options.failure_mode() == parse_options::on_error::fail_immediately)
         {
@@ -369,9 +392,278 @@ private:
         stream << std::forward<T>(current);
         parse_error_impl(stream, std::forward<TRest>(rest)...);
     }
+    
+    /** Get the end of the current token or \a fallback if there is no current token. **/
+    const char* current_end_or(const char* fallback) const
+    {
+        try
+        {
+            string_view text = current().text;
+            return text.data() + text.size();
+        }
+        catch (const std::logic_error&)
+        {
+            return fallback;
+        }
+    }
+    
+    /** The location a problem should be reported at: the start of the current token or, once the input is exhausted,
+     *  the end of the last one. If there is no token at all, this is the start of the input.
+    **/
+    const char* error_position() const
+    {
+        if (complete)
+            return current_end_or(input.input().data());
+        
+        try
+        {
+            return current().text.data();
+        }
+        catch (const std::logic_error&)
+        {
+            return input.input().data();
+        }
+    }
 };
 
-static bool parse_generic(parse_context& context, value& out, bool advance = true);
+/** Remove the quotes around a verbatim string token. **/
+static string_view unquote(string_view source)
+{
+    source.remove_prefix(1);
+    source.remove_suffix(1);
+    return source;
+}
+
+static std::string decode_string(parse_context& context)
+{
+    assert(context.current_kind() == token_kind::string);
+    
+    string_view source = unquote(context.current().text);
+    JSONV_DBG_STRUCT(source);
+    
+    // no escapes or multi-byte sequences, so there is nothing to decode
+    if (context.current().verbatim)
+        return std::string(source);
+    
+    try
+    {
+        return context.string_decode(source);
+    }
+    catch (const detail::decode_error& err)
+    {
+        context.parse_error("Error decoding string:", err.what());
+        // return it un-decoded
+        return std::string(source);
+    }
+}
+
+/** Builds a \c value tree from the events of \c parse_document. This is what the DOM \c parse functions use; it is
+ *  called directly instead of through a \c parse_handler so building a tree does not pay for a virtual call per token.
+ *  
+ *  When the input ends early, the structures which were never closed are left open. \c result then keeps what was
+ *  parsed of the outermost one and drops the rest, which is the partial result given to \c parse_error.
+**/
+class JSONV_LOCAL value_builder
+{
+public:
+    explicit value_builder(parse_context& context, arena* region) :
+            _context(context),
+            _region(region)
+    { }
+    
+    void null()                  { complete(value()); }
+    void boolean(bool x)         { complete(value(x)); }
+    void integer(std::int64_t x) { complete(value(x)); }
+    void decimal(double x)       { complete(value(x)); }
+    
+    void string(parse_context& context)
+    {
+        // the text of a token read from a stream is overwritten as the stream is read, so it can not be borrowed
+        if (context.options.borrow_strings() && context.current().verbatim && context.input.input_is_stable())
+            complete(borrowed_string(unquote(context.current().text)));
+        else if (_region)
+            complete(value(*_region, decode_string(context)));
+        else
+            complete(value(decode_string(context)));
+    }
+    
+    /** Allocate what is built from now on from \a region, or from the heap if it is \c nullptr. **/
+    void region(arena* region)
+    {
+        _region = region;
+    }
+    
+    void array_begin()
+    {
+        _frames.emplace_back(_region ? array(*_region) : array(), _elements.size());
+    }
+    
+    void array_end()
+    {
+        frame done = std::move(_frames.back());
+        _frames.pop_back();
+        take_elements(done.first_element, done.container);
+        complete(std::move(done.container));
+    }
+    
+    void object_begin()
+    {
+        _frames.emplace_back(_region ? object(*_region) : object(), 0);
+    }
+    
+    /** Use \a key for the next value of the current object. It is moved from once that value is complete, so it must
+     *  live until then.
+    **/
+    void key(std::string& key)
+    {
+        _frames.back().key = &key;
+    }
+    
+    void object_end()
+    {
+        frame done = std::move(_frames.back());
+        _frames.pop_back();
+        complete(std::move(done.container));
+    }
+    
+    jsonv::kind root_kind() const
+    {
+        return _root.kind();
+    }
+    
+    /** Get the parsed tree. If the input ended early, this is the outermost open structure with what was parsed of
+     *  it.
+    **/
+    value result()
+    {
+        if (!_frames.empty())
+        {
+            // Anything left open inside of the outermost structure is incomplete, so drop it
+            for (auto iter = _frames.rbegin(); iter != std::prev(_frames.rend()); ++iter)
+            {
+                if (iter->container.kind() == jsonv::kind::array)
+                    _elements.erase(_elements.begin() + iter->first_element, _elements.end());
+            }
+            
+            frame& outermost = _frames.front();
+            if (outermost.container.kind() == jsonv::kind::array)
+                take_elements(outermost.first_element, outermost.container);
+            _root = std::move(outermost.container);
+            _frames.clear();
+        }
+        return std::move(_root);
+    }
+    
+private:
+    struct frame
+    {
+        frame(value container, std::size_t first_element) :
+                container(std::move(container)),
+                first_element(first_element)
+        { }
+        
+        value        container;
+        std::size_t  first_element;  //!< For arrays, where the elements of this array start in \c _elements
+        std::string* key = nullptr;  //!< For objects, the key of the value being parsed (owned by \c parse_object)
+    };
+    
+private:
+    /** Add the finished value \a x to the structure being parsed or make it the result if there is none. **/
+    void complete(value&& x)
+    {
+        if (_frames.empty())
+        {
+            _root = std::move(x);
+            return;
+        }
+        
+        frame& top = _frames.back();
+        if (top.container.kind() == jsonv::kind::array)
+        {
+            _elements.push_back(std::move(x));
+            return;
+        }
+        
+        // Insert a placeholder to find the key's position and check for duplicates with a single lookup. Objects are
+        // frequently written in sorted order, so hint that the key probably goes at the end.
+        auto size_before = top.container.size();
+        auto iter        = top.container.insert(top.container.end_object(), { std::move(*top.key), value() });
+        if (top.container.size() == size_before)
+        {
+            _context.parse_error("Duplicate entries for key '", iter->first, "'. ",
+                                 "Updating old value ", iter->second, " with new value ", x, "."
+                                );
+        }
+        iter->second = std::move(x);
+    }
+    
+    /** Move the \c _elements from \a first onward into \a arr. **/
+    void take_elements(std::size_t first, value& arr)
+    {
+        arr.reserve(_elements.size() - first);
+        for (auto iter = _elements.begin() + first; iter != _elements.end(); ++iter)
+            arr.push_back(std::move(*iter));
+        _elements.erase(_elements.begin() + first, _elements.end());
+    }
+    
+private:
+    parse_context&     _context;
+    arena*             _region;
+    value              _root;
+    std::vector<frame> _frames;
+    
+    /** Elements of the arrays currently being parsed. They are kept here until the closing \c ']' so that each array
+     *  can be allocated at its final size.
+    **/
+    std::vector<value> _elements;
+};
+
+/** Forwards the events of \c parse_document to a user-provided \c parse_handler. **/
+class JSONV_LOCAL handler_events
+{
+public:
+    explicit handler_events(parse_handler& handler) :
+            _handler(handler),
+            _root_kind(jsonv::kind::null)
+    { }
+    
+    void null()                  { _handler.on_null();     _root_kind = jsonv::kind::null; }
+    void boolean(bool x)         { _handler.on_boolean(x); _root_kind = jsonv::kind::boolean; }
+    void integer(std::int64_t x) { _handler.on_integer(x); _root_kind = jsonv::kind::integer; }
+    void decimal(double x)       { _handler.on_decimal(x); _root_kind = jsonv::kind::decimal; }
+    void array_begin()           { _handler.on_array_begin(); }
+    void array_end()             { _handler.on_array_end();  _root_kind = jsonv::kind::array; }
+    void object_begin()          { _handler.on_object_begin(); }
+    void object_end()            { _handler.on_object_end(); _root_kind = jsonv::kind::object; }
+    
+    void string(parse_context& context)
+    {
+        if (context.current().verbatim)
+            _handler.on_string(unquote(context.current().text));
+        else
+            _handler.on_string(_scratch = decode_string(context));
+        _root_kind = jsonv::kind::string;
+    }
+    
+    void key(const std::string& key)
+    {
+        _handler.on_key(key);
+    }
+    
+    /** The kind of the last value to be completed, which is the root once the document has been parsed. **/
+    jsonv::kind root_kind() const
+    {
+        return _root_kind;
+    }
+    
+private:
+    parse_handler& _handler;
+    jsonv::kind    _root_kind;
+    std::string    _scratch;  //!< Storage for decoded strings
+};
+
+template <typename TEvents>
+static bool parse_generic(parse_context& context, TEvents& events, bool advance = true);
 
 static void check_token(parse_context& context, string_view expected_token)
 {
@@ -382,18 +674,19 @@ static void check_token(parse_context& context, string_view expected_token)
         );
 }
 
-static bool parse_boolean(parse_context& context, value& out)
+template <typename TEvents>
+static bool parse_boolean(parse_context& context, TEvents& events)
 {
     assert(context.current_kind() == token_kind::boolean);
     switch (context.current().text.at(0))
     {
     case 't':
-        out = true;
         check_token(context, "true");
+        events.boolean(true);
         return true;
     case 'f':
-        out = false;
         check_token(context, "false");
+        events.boolean(false);
         return true;
     default:
         assert(false);
@@ -401,15 +694,17 @@ static bool parse_boolean(parse_context& context, value& out)
     }
 }
 
-static bool parse_null(parse_context& context, value& out)
+template <typename TEvents>
+static bool parse_null(parse_context& context, TEvents& events)
 {
     assert(context.current_kind() == token_kind::null);
-    out = null;
     check_token(context, "null");
+    events.null();
     return true;
 }
 
-static bool parse_number(parse_context& context, value& out)
+template <typename TEvents>
+static bool parse_number(parse_context& context, TEvents& events)
 {
     JSONV_DBG_STRUCT("#");
     string_view characters = context.current().text;
@@ -422,90 +717,62 @@ static bool parse_number(parse_context& context, value& out)
         context.parse_error("Numbers cannot start with a leading '0'");
     }
 
-    auto end = const_cast<char*>(characters.data() + characters.length());
-
-    // optimization: a numeric token is "decimal-like" if it has . in it
-    if (characters.find_first_of(".Ee") != string_view::npos)
-    {
-        auto scan_end = end;
-        auto val = std::strtod(characters.data(), &scan_end);
-        if (end == scan_end)
-        {
-            out = val;
-            return true;
-        }
-    }
-    else if (characters[0] == '-')
+    decoded_number number;
+    if (decode_number(characters, number))
     {
-        auto scan_end = end;
-        auto val      = std::strtoul(characters.data(), &scan_end, 10);
-        if (end == scan_end)
-        {
-            out = val;
-            return true;
-        }
-    }
-    else
-    {
-        // For non-negative integer types, use lexical_cast of a uint64_t then static_cast to an int64_t. This is done
-        // to deal with the values 2^63..2^64-1 -- do not consider it an exception, as we can store the bits properly,
-        // but the onus is on the user to know the particular key was in the overflow range.
-        auto scan_end = end;
-        auto val      = std::strtoull(characters.data(), &scan_end, 10);
-        if (end == scan_end)
-        {
-            out = val;
-            return true;
-        }
-    }
-
-    // Numbers that do not contain decimals or exponents, but are too large might still be representable as a double
-    {
-        auto scan_end = end;
-        auto val = std::strtod(characters.data(), &scan_end);
-        if (end == scan_end)
-        {
-            out = val;
-            return true;
-        }
+        if (number.is_integer)
+            events.integer(number.integer);
+        else
+            events.decimal(number.decimal);
+        return true;
     }
 
     context.parse_error("Could not extract number from \"", characters, "\"");
+    events.null();
     return true;
 }
 
-static std::string parse_string(parse_context& context)
+/** Skip over the rest of the array or object the current token opens without building anything. This is used when the
+ *  structure is too deep, so it keeps a count instead of recursing.
+**/
+static bool skip_structure(parse_context& context)
 {
-    assert(context.current_kind() == token_kind::string);
-    
-    string_view source = context.current().text;
-    JSONV_DBG_STRUCT(source);
-    // chop off the ""s
-    source.remove_prefix(1);
-    source.remove_suffix(1);
-    
-    try
-    {
-        return context.string_decode(source);
-    }
-    catch (const detail::decode_error& err)
+    parse_context::size_type open = 1;
+    while (context.next())
     {
-        context.parse_error("Error decoding string:", err.what());
-        // return it un-decoded
-        return std::string(source);
+        switch (context.current_kind())
+        {
+        case token_kind::array_begin:
+        case token_kind::object_begin:
+            ++open;
+            break;
+        case token_kind::array_end:
+        case token_kind::object_end:
+            if (--open == 0)
+                return true;
+            break;
+        default:
+            break;
+        }
     }
+    context.parse_error("Unexpected end inside of skipped structure.");
+    return false;
 }
 
-static bool parse_string(parse_context& context, value& out)
-{
-    out = parse_string(context);
-    return true;
-}
-
-static bool parse_array(parse_context& context, value& arr)
+template <typename TEvents>
+static bool parse_array(parse_context& context, TEvents& events)
 {
     JSONV_DBG_STRUCT('[');
-    arr = array();
+    events.array_begin();
+    if (!context.enter_structure())
+    {
+        if (!skip_structure(context))
+            return false;
+        events.array_end();
+        return true;
+    }
+    auto leave = on_scope_exit([&context] { context.leave_structure(); });
+    
     bool trailing_comma = false;
     
     while (true)
@@ -513,18 +780,16 @@ static bool parse_array(parse_context& context, value& arr)
         if (!context.next())
             break;
         
-        value val;
         if (context.current_kind() == token_kind::array_end)
         {
             if (trailing_comma && context.options.comma_policy() != parse_options::commas::allow_trailing)
                 context.parse_error("Array contained a trailing comma");
             JSONV_DBG_STRUCT(']');
+            events.array_end();
             return true;
         }
-        else if (parse_generic(context, val, false))
+        else if (parse_generic(context, events, false))
         {
-            JSONV_DBG_STRUCT(val);
-            arr.push_back(std::move(val));
             trailing_comma = false;
         }
         else
@@ -541,6 +806,7 @@ static bool parse_array(parse_context& context, value& arr)
         if (context.current_kind() == token_kind::array_end)
         {
             JSONV_DBG_STRUCT(']');
+            events.array_end();
             return true;
         }
         else if (context.current_kind() == token_kind::separator)
@@ -557,31 +823,47 @@ static bool parse_array(parse_context& context, value& arr)
     return false;
 }
 
-static bool parse_object(parse_context& context, value& out)
+template <typename TEvents>
+static bool parse_object(parse_context& context, TEvents& events)
 {
-    out = object();
+    events.object_begin();
+    if (!context.enter_structure())
+    {
+        if (!skip_structure(context))
+            return false;
+        events.object_end();
+        return true;
+    }
+    auto leave = on_scope_exit([&context] { context.leave_structure(); });
+    
     bool trailing_comma = false;
     
+    // The key is kept here instead of in events, since a nested value which fails leaves its own structure open
+    std::string key;
     while (context.next())
     {
-        std::string key;
         if (context.current_kind() == token_kind::string)
         {
-            key = parse_string(context);
+            if (context.current().verbatim)
+                key.assign(unquote(context.current().text).data(), unquote(context.current().text).size());
+            else
+                key = decode_string(context);
             trailing_comma = false;
         }
         else if (context.current_kind() == token_kind::object_end)
         {
             if (trailing_comma && context.options.comma_policy() != parse_options::commas::allow_trailing)
                 context.parse_error("Trailing comma at end of object.");
+            events.object_end();
             return true;
         }
         else
         {
             context.parse_error("Expecting a key, but found ", context.current_kind());
             // simulate a new key
-            key = std::string(context.current().text);
+            key.assign(context.current().text.data(), context.current().text.size());
         }
+        events.key(key);
         
         if (!context.next())
         {
@@ -592,35 +874,28 @@ static bool parse_object(parse_context& context, value& out)
         if (context.current_kind() != token_kind::object_key_delimiter)
             context.parse_error("Invalid key-value delimiter...expecting ':' after key '", key, "'");
         
-        value val;
-        if (!parse_generic(context, val))
+        if (!parse_generic(context, events))
         {
             context.parse_error("Unexpected end: incomplete value for key '", key, "'");
             return false;
         }
         
-        auto iter = out.find(key);
-        if (iter == out.end_object())
-        {
-            out.insert({ std::move(key), std::move(val) });
-        }
-        else
-        {
-            context.parse_error("Duplicate entries for key '", key, "'. ",
-                                "Updating old value ", iter->second, " with new value ", val, "."
-                               );
-            iter->second = std::move(val);
-        }
-        
         if (!context.next())
             break;
         
         if (context.current_kind() == token_kind::object_end)
+        {
+            events.object_end();
             return true;
+        }
         else if (context.current_kind() == token_kind::separator)
+        {
             trailing_comma = true;
+        }
         else
+        {
             context.parse_error("Invalid token while searching for next value in object.");
+        }
     }
     
     context.parse_error("Unexpected end inside of object.");
@@ -655,7 +930,8 @@ static bool forward_to_separator(parse_context& context)
     return false;
 }
 
-static bool parse_generic(parse_context& context, value& out, bool advance)
+template <typename TEvents>
+static bool parse_generic(parse_context& context, TEvents& events, bool advance)
 {
     if (advance && !context.next())
         return false;
@@ -663,21 +939,22 @@ static bool parse_generic(parse_context& context, value& out, bool advance)
     switch (context.current().kind)
     {
     case token_kind::array_begin:
-        return parse_array(context, out);
+        return parse_array(context, events);
     case token_kind::boolean:
-        return parse_boolean(context, out);
+        return parse_boolean(context, events);
     case token_kind::null:
-        return parse_null(context, out);
+        return parse_null(context, events);
     case token_kind::number:
-        return parse_number(context, out);
+        return parse_number(context, events);
     case token_kind::object_begin:
-        return parse_object(context, out);
+        return parse_object(context, events);
     case token_kind::string:
-        return parse_string(context, out);
+        events.string(context);
+        return true;
     case token_kind::comment:
     case token_kind::whitespace:
         // ignore
-        return parse_generic(context, out);
+        return parse_generic(context, events);
     case token_kind::unknown:
     case token_kind::array_end:
     case token_kind::object_end:
@@ -686,63 +963,23 @@ static bool parse_generic(parse_context& context, value& out, bool advance)
     case token_kind::parse_error_indicator:
     default:
         context.parse_error("Encountered invalid token ", context.current().kind, ": \"", context.current().text, "\"");
-        return forward_to_separator(context);
+        if (!forward_to_separator(context))
+            return false;
+        // the invalid token stands in as a null
+        events.null();
+        return true;
     }
 }
 
-class JSONV_LOCAL depth_checker :
-        private encoder
+/** Parse one value from the input of \a context, sending it to \a events, and check what comes after it. Problems are
+ *  recorded in \a context (or thrown, depending on the \c parse_options::failure_mode).
+**/
+template <typename TEvents>
+static void parse_document(parse_context& context, TEvents& events)
 {
-public:
-    explicit depth_checker(parse_context& context) :
-            _context(context),
-            _current_depth(0)
-    { }
-    
-    void check(const value& val)
-    {
-        encode(val);
-    }
-    
-private:
-    virtual void write_null() override                      { }
-    virtual void write_object_key(string_view) override      { }
-    virtual void write_object_delimiter() override          { }
-    virtual void write_array_delimiter() override           { }
-    virtual void write_string(string_view) override          { }
-    virtual void write_integer(std::int64_t) override       { }
-    virtual void write_decimal(double) override             { }
-    virtual void write_boolean(bool) override               { }
-    
-    virtual void write_object_begin() override { increase_depth(); }
-    virtual void write_array_begin() override  { increase_depth(); }
-    virtual void write_object_end() override   { --_current_depth; }
-    virtual void write_array_end() override    { --_current_depth; }
-    
-private:
-    void increase_depth()
-    {
-        if (++_current_depth == _context.options.max_structure_depth())
-        {
-            _context.parse_error("Structure depth reached maximum of ", _current_depth);
-        }
-    }
+    if (!parse_generic(context, events))
+        context.parse_error("No input");
     
-private:
-    parse_context&           _context;
-    parse_options::size_type _current_depth;
-};
-
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// parse functions                                                                                                    //
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-static value post_parse(detail::parse_context& context, value&& out_)
-{
-    // allow RVO
-    value out(std::move(out_));
     if (context.successful && context.options.complete_parse())
     {
         while (context.next())
@@ -763,32 +1000,210 @@ static value post_parse(detail::parse_context& context, value&& out_)
     
     if (context.successful && context.options.require_document())
     {
-        if (out.kind() != kind::array && out.kind() != kind::object)
-        {
-            context.parse_error("JSON requires the root of a payload to be an array or object, not ", out.kind());
-        }
+        jsonv::kind root = events.root_kind();
+        if (root != kind::array && root != kind::object)
+            context.parse_error("JSON requires the root of a payload to be an array or object, not ", root);
     }
+}
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// parse_handler                                                                                                      //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+parse_handler::~parse_handler() noexcept = default;
+
+void parse_handler::on_null()
+{ }
+
+void parse_handler::on_boolean(bool)
+{ }
+
+void parse_handler::on_integer(std::int64_t)
+{ }
+
+void parse_handler::on_decimal(double)
+{ }
+
+void parse_handler::on_string(string_view)
+{ }
+
+void parse_handler::on_array_begin()
+{ }
+
+void parse_handler::on_array_end()
+{ }
+
+void parse_handler::on_object_begin()
+{ }
+
+void parse_handler::on_key(string_view)
+{ }
+
+void parse_handler::on_object_end()
+{ }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// parse functions                                                                                                    //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static value parse_impl(tokenizer& input, const parse_options& options, arena* region)
+{
+    detail::parse_context context(options, input);
+    detail::value_builder builder(context, region);
+    detail::parse_document(context, builder);
+    
+    value out = builder.result();
+    if (context.successful || context.options.failure_mode() == parse_options::on_error::ignore)
+        return out;
+    else
+        throw parse_error(context.problems, std::move(out));
+}
+
+value parse_current(tokenizer& input, const parse_options& options)
+{
+    detail::parse_context context(options, input);
+    detail::value_builder builder(context, nullptr);
+    detail::parse_generic(context, builder, false);
+    
+    value out = builder.result();
+    if (context.successful || context.options.failure_mode() == parse_options::on_error::ignore)
+        return out;
+    else
+        throw parse_error(context.problems, std::move(out));
+}
+
+value parse_nested(const string_view& input, const parse_options& options, std::size_t depth)
+{
+    tokenizer             tokens(input);
+    detail::parse_context context(options, tokens);
+    detail::value_builder builder(context, nullptr);
+    context.depth = depth;
+    detail::parse_document(context, builder);
     
-    if (context.options.max_structure_depth() > 0)
+    value out = builder.result();
+    if (context.successful || context.options.failure_mode() == parse_options::on_error::ignore)
+        return out;
+    else
+        throw parse_error(context.problems, std::move(out));
+}
+
+struct JSONV_LOCAL detail::record_parser::impl
+{
+    tokenizer             tokens;
+    detail::parse_context context;
+    detail::value_builder builder;
+    
+    explicit impl(const parse_options& options) :
+            tokens(string_view()),
+            context(options, tokens),
+            builder(context, nullptr)
+    { }
+};
+
+detail::record_parser::record_parser(const parse_options& options) :
+        _impl(new impl(options))
+{ }
+
+detail::record_parser::~record_parser() noexcept = default;
+
+const parse_options& detail::record_parser::options() const
+{
+    return _impl->context.options;
+}
+
+value detail::record_parser::parse(const string_view& input, parse_error::problem_list& problems, arena* region)
+{
+    _impl->tokens.reset(input);
+    _impl->context.reset();
+    _impl->builder.region(region);
+    problems.clear();
+    try
+    {
+        detail::parse_document(_impl->context, _impl->builder);
+    }
+    catch (const parse_error& err)
     {
-        detail::depth_checker depth_checker(context);
-        depth_checker.check(out);
+        // fail_immediately: clear out whatever was built, so the next input starts clean
+        _impl->builder.result();
+        problems = err.problems();
+        return null;
     }
     
-    if (context.successful || context.options.failure_mode() == parse_options::on_error::ignore)
+    value out = _impl->builder.result();
+    if (!_impl->context.successful && _impl->context.options.failure_mode() != parse_options::on_error::ignore)
+        problems = std::move(_impl->context.problems);
+    return out;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// parser                                                                                                             //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+parser::parser(const parse_options& options) :
+        _impl(new detail::record_parser(options))
+{ }
+
+parser::parser(parser&&) noexcept = default;
+
+parser& parser::operator=(parser&&) noexcept = default;
+
+parser::~parser() noexcept = default;
+
+const parse_options& parser::options() const
+{
+    return _impl->options();
+}
+
+value parser::parse(const string_view& input)
+{
+    value out = _impl->parse(input, _problems);
+    if (_problems.empty())
         return out;
     else
-        throw parse_error(context.problems, out);
+        throw parse_error(std::move(_problems), std::move(out));
+}
+
+value parser::parse(const string_view& input, arena& region)
+{
+    value out = _impl->parse(input, _problems, &region);
+    if (_problems.empty())
+        return out;
+    else
+        throw parse_error(std::move(_problems), std::move(out));
 }
 
 value parse(tokenizer& input, const parse_options& options)
+{
+    return parse_impl(input, options, nullptr);
+}
+
+value parse(tokenizer& input, arena& region, const parse_options& options)
+{
+    return parse_impl(input, options, &region);
+}
+
+void parse(tokenizer& input, parse_handler& handler, const parse_options& options)
 {
     detail::parse_context context(options, input);
-    value out;
-    if (!detail::parse_generic(context, out))
-        context.parse_error("No input");
+    detail::handler_events events(handler);
+    detail::parse_document(context, events);
     
-    return post_parse(context, std::move(out));
+    if (!context.successful && context.options.failure_mode() != parse_options::on_error::ignore)
+        throw parse_error(context.problems, null);
+}
+
+void parse(const string_view& input, parse_handler& handler, const parse_options& options)
+{
+    tokenizer tokens(input);
+    parse(tokens, handler, options);
+}
+
+value parse(const string_view& input, arena& region, const parse_options& options)
+{
+    tokenizer tokens(input);
+    return parse(tokens, region, options);
 }
 
 value parse(std::istream& input, const parse_options& options)
@@ -797,6 +1212,12 @@ value parse(std::istream& input, const parse_options& options)
     return parse(tokens, options);
 }
 
+value parse_file(const std::string& path, const parse_options& options)
+{
+    mapped_file file(path);
+    return parse(file.contents(), parse_options(options).borrow_strings(false));
+}
+
 value parse(const string_view& input, const parse_options& options)
 {
     tokenizer tokens(input);
@@ -0,0 +1,231 @@
+/** \file
+ *  
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv/array.hpp>
+#include <jsonv/parse.hpp>
+#include <jsonv/tokenizer.hpp>
+#include <jsonv/detail/scope_exit.hpp>
+
+#include "detail.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace jsonv
+{
+
+namespace
+{
+
+/** Move \a input to the next token which is not whitespace or a comment.
+ *  
+ *  \returns \c false if the input ended or if there is a problem, which \c parse will report.
+**/
+bool next_significant(tokenizer& input, const parse_options& options)
+{
+    while (input.next())
+    {
+        token_kind kind = input.current().kind;
+        if (kind == token_kind::whitespace)
+            continue;
+        else if (kind == token_kind::comment && options.comments())
+            continue;
+        else
+            return kind != token_kind::comment
+                && (kind & token_kind::parse_error_indicator) != token_kind::parse_error_indicator;
+    }
+    return false;
+}
+
+/** Find the text of each element of the top-level array of \a input. Only the structure of the array itself is checked;
+ *  nested arrays and objects are skipped over with \c tokenizer::skip_structure.
+ *  
+ *  \returns \c false if \a input is not an array or if there is a problem outside of the elements. In these cases, the
+ *  input is left to \c parse, so it can report the problem exactly as it always would.
+**/
+bool find_elements(const string_view& input, const parse_options& options, std::vector<string_view>& elements)
+{
+    tokenizer tokens(input);
+    if (!next_significant(tokens, options) || tokens.current().kind != token_kind::array_begin)
+        return false;
+    if (options.max_structure_depth() == 1)
+        return false;
+    
+    bool after_comma = false;
+    while (true)
+    {
+        if (!next_significant(tokens, options))
+            return false;
+        
+        if (tokens.current().kind == token_kind::array_end)
+        {
+            if (after_comma && options.comma_policy() != parse_options::commas::allow_trailing)
+                return false;
+            break;
+        }
+        
+        const char* begin = tokens.current().text.data();
+        if (tokens.current().kind == token_kind::array_begin || tokens.current().kind == token_kind::object_begin)
+        {
+            if (!tokens.skip_structure())
+                return false;
+        }
+        else if (  tokens.current().kind == token_kind::object_end
+                || tokens.current().kind == token_kind::separator
+                || tokens.current().kind == token_kind::object_key_delimiter
+                )
+        {
+            return false;
+        }
+        string_view last = tokens.current().text;
+        elements.emplace_back(begin, size_t(last.data() + last.size() - begin));
+        
+        if (!next_significant(tokens, options))
+            return false;
+        if (tokens.current().kind == token_kind::array_end)
+            break;
+        else if (tokens.current().kind != token_kind::separator)
+            return false;
+        after_comma = true;
+    }
+    
+    if (options.complete_parse())
+    {
+        while (tokens.next())
+        {
+            // The same as the check in parse: whitespace and trailing nulls are fine; anything else is a problem
+            const tokenizer::token& token = tokens.current();
+            if (  token.kind == token_kind::whitespace
+               || token.kind == token_kind::unknown
+               || (token.kind == token_kind::comment && options.comments())
+               || std::all_of(token.text.begin(), token.text.end(), [] (char c) { return c == '\0'; })
+               )
+            {
+                continue;
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+value parse_parallel(const string_view& input, const parse_options& options, std::size_t thread_count)
+{
+    if (thread_count == 0)
+        thread_count = std::max(1U, std::thread::hardware_concurrency());
+    
+    std::vector<string_view> elements;
+    if (thread_count == 1 || !find_elements(input, options, elements) || elements.size() < 2U)
+        return parse(input, options);
+    
+    // Each element is parsed as a value on its own, one level below the top-level array. Any problem means the input is
+    // handed to parse, so there is no point in going past the first one, even when the caller ignores problems.
+    parse_options element_options = parse_options(options)
+                                   .require_document(false)
+                                   .complete_parse(true)
+                                   .failure_mode(parse_options::on_error::fail_immediately);
+    
+    std::vector<value>       results(elements.size());
+    std::size_t              batch_size = std::max<std::size_t>(1U, elements.size() / (thread_count * 8));
+    std::atomic<std::size_t> next_batch(0);
+    // Once an element has a problem, the input is parsed again by parse, so the rest of the elements can be skipped
+    std::atomic<bool>        failed(false);
+    
+    auto work = [&] ()
+                {
+                    while (!failed.load(std::memory_order_relaxed))
+                    {
+                        std::size_t first = next_batch.fetch_add(batch_size);
+                        if (first >= elements.size())
+                            return;
+                        
+                        std::size_t last = std::min(first + batch_size, elements.size());
+                        for (std::size_t idx = first; idx < last && !failed.load(std::memory_order_relaxed); ++idx)
+                        {
+                            try
+                            {
+                                results[idx] = parse_nested(elements[idx], element_options, 1);
+                            }
+                            catch (const parse_error&)
+                            {
+                                failed.store(true, std::memory_order_relaxed);
+                            }
+                        }
+                    }
+                };
+    
+    std::vector<std::exception_ptr> worker_errors(thread_count);
+    {
+        std::vector<std::thread> workers;
+        workers.reserve(thread_count - 1);
+        // Joined on the way out no matter what, since destroying a joinable std::thread calls std::terminate
+        auto join_workers = detail::on_scope_exit([&workers]
+                                                  {
+                                                      for (std::thread& worker : workers)
+                                                          worker.join();
+                                                  }
+                                                 );
+        for (std::size_t worker = 1; worker < thread_count; ++worker)
+        {
+            try
+            {
+                workers.emplace_back([&work, &worker_errors, worker]
+                                     {
+                                         try
+                                         {
+                                             work();
+                                         }
+                                         catch (...)
+                                         {
+                                             worker_errors[worker] = std::current_exception();
+                                         }
+                                     }
+                                    );
+            }
+            catch (const std::system_error&)
+            {
+                // Out of threads -- the ones which did start (and this one) will get through all the batches
+                break;
+            }
+        }
+        try
+        {
+            work();
+        }
+        catch (...)
+        {
+            worker_errors[0] = std::current_exception();
+        }
+    }
+    for (const std::exception_ptr& error : worker_errors)
+        if (error)
+            std::rethrow_exception(error);
+    
+    // How the parser recovers from a problem depends on everything after it, not just the rest of the element, so the
+    // problems and partial result only match parse if parse sees the whole input. Invalid input is expected to be rare,
+    // so parsing it twice is a fair price.
+    if (failed.load())
+        return parse(input, options);
+    
+    value out = array();
+    out.reserve(elements.size());
+    for (value& element : results)
+        out.push_back(std::move(element));
+    return out;
+}
+
+}
@@ -0,0 +1,441 @@
+/** \file
+ *  
+ *  Copyright (c) 2019 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv/reader.hpp>
+#include <jsonv/tokenizer.hpp>
+#include <jsonv/detail/fallthrough.hpp>
+#include <jsonv/detail/number_convert.hpp>
+
+#include "char_convert.hpp"
+#include "detail.hpp"
+
+#include <algorithm>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace jsonv
+{
+
+std::ostream& operator<<(std::ostream& os, const reader::event& value)
+{
+    switch (value)
+    {
+    case reader::event::null:         return os << "null";
+    case reader::event::boolean:      return os << "boolean";
+    case reader::event::integer:      return os << "integer";
+    case reader::event::decimal:      return os << "decimal";
+    case reader::event::string:       return os << "string";
+    case reader::event::array_begin:  return os << "array_begin";
+    case reader::event::array_end:    return os << "array_end";
+    case reader::event::object_begin: return os << "object_begin";
+    case reader::event::key:          return os << "key";
+    case reader::event::object_end:   return os << "object_end";
+    case reader::event::end:          return os << "end";
+    default:                          return os << "reader::event(" << static_cast<int>(value) << ")";
+    }
+}
+
+static void stream_all(std::ostream&)
+{ }
+
+template <typename T, typename... TRest>
+static void stream_all(std::ostream& os, T&& first, TRest&&... rest)
+{
+    os << std::forward<T>(first);
+    stream_all(os, std::forward<TRest>(rest)...);
+}
+
+reader::reader(tokenizer& input, const parse_options& options) :
+        _input(input),
+        _options(parse_options(options).failure_mode(parse_options::on_error::fail_immediately)),
+        _event(event::end),
+        _after_key(false),
+        _root_finished(false),
+        _input_ended(false),
+        _boolean(false),
+        _integer(0),
+        _decimal(0.0)
+{ }
+
+reader::reader(string_view input, const parse_options& options) :
+        _owned_input(new tokenizer(input)),
+        _input(*_owned_input),
+        _options(parse_options(options).failure_mode(parse_options::on_error::fail_immediately)),
+        _event(event::end),
+        _after_key(false),
+        _root_finished(false),
+        _input_ended(false),
+        _boolean(false),
+        _integer(0),
+        _decimal(0.0)
+{ }
+
+reader::~reader() noexcept = default;
+
+reader::event reader::current_event() const
+{
+    return _event;
+}
+
+reader::size_type reader::depth() const
+{
+    return _frames.size();
+}
+
+template <typename... T>
+void reader::parse_error(T&&... message) const
+{
+    std::ostringstream stream;
+    stream_all(stream, std::forward<T>(message)...);
+    
+    // Report the problem at the start of the current token or, once the input is exhausted, the end of the last one
+    const char* position = _input.input().data();
+    try
+    {
+        string_view text = _input.current().text;
+        stream << ": \"" << text << "\"";
+        position = _input_ended ? text.data() + text.size() : text.data();
+    }
+    catch (const std::logic_error&)
+    { }
+    
+    tokenizer::size_type line, column, character;
+    _input.locate(position, line, column, character);
+    throw jsonv::parse_error({ parse_error::problem(line, column, character, stream.str()) }, null);
+}
+
+bool reader::next_token()
+{
+    while (_input.next())
+    {
+        const tokenizer::token& token = _input.current();
+        if (token.kind == token_kind::whitespace)
+        {
+            continue;
+        }
+        else if (token.kind == token_kind::comment)
+        {
+            if (!_options.comments())
+                parse_error("JSON comment is not allowed");
+        }
+        else if ((token.kind & token_kind::parse_error_indicator) == token_kind::parse_error_indicator)
+        {
+            parse_error("Encountered invalid token ", token.kind);
+        }
+        else
+        {
+            return true;
+        }
+    }
+    
+    _input_ended = true;
+    return false;
+}
+
+reader::event reader::start_value()
+{
+    const tokenizer::token& token = _input.current();
+    
+    if (  _frames.empty()
+       && _options.require_document()
+       && token.kind != token_kind::array_begin
+       && token.kind != token_kind::object_begin
+       )
+    {
+        parse_error("JSON requires the root of a payload to be an array or object, not ", token.kind);
+    }
+    
+    switch (token.kind)
+    {
+    case token_kind::array_begin:
+    case token_kind::object_begin:
+        if (_frames.size() + 1 == _options.max_structure_depth())
+            parse_error("Structure depth reached maximum of ", _frames.size() + 1);
+        _frames.push_back({ token.kind == token_kind::object_begin, false, false });
+        return _event = token.kind == token_kind::object_begin ? event::object_begin : event::array_begin;
+    case token_kind::null:
+        if (token.text != "null")
+            parse_error("Failed to match \"null\"");
+        finish_value();
+        return _event = event::null;
+    case token_kind::boolean:
+        if (token.text != "true" && token.text != "false")
+            parse_error("Failed to match a boolean");
+        _boolean = token.text == "true";
+        finish_value();
+        return _event = event::boolean;
+    case token_kind::number:
+    {
+        if (  _options.number_encoding() == parse_options::numbers::strict
+           && token.text.size() > 1U
+           && token.text[0] == '0'
+           )
+        {
+            parse_error("Numbers cannot start with a leading '0'");
+        }
+        
+        detail::decoded_number number;
+        if (!detail::decode_number(token.text, number))
+            parse_error("Could not extract number from \"", token.text, "\"");
+        finish_value();
+        if (number.is_integer)
+        {
+            _integer = number.integer;
+            return _event = event::integer;
+        }
+        else
+        {
+            _decimal = number.decimal;
+            return _event = event::decimal;
+        }
+    }
+    case token_kind::string:
+    {
+        string_view source = token.text;
+        source.remove_prefix(1);
+        source.remove_suffix(1);
+        if (token.verbatim)
+        {
+            _string = source;
+        }
+        else
+        {
+            try
+            {
+                _decoded = detail::get_string_decoder(_options.string_encoding())(source);
+            }
+            catch (const detail::decode_error& err)
+            {
+                parse_error("Error decoding string:", err.what());
+            }
+            _string = _decoded;
+        }
+        finish_value();
+        return _event = event::string;
+    }
+    default:
+        parse_error("Encountered invalid token ", token.kind);
+    }
+}
+
+void reader::start_keyed_value()
+{
+    _after_key = false;
+    if (!next_token())
+        parse_error("Unexpected end: missing ':' for key");
+    if (_input.current().kind != token_kind::object_key_delimiter)
+        parse_error("Invalid key-value delimiter...expecting ':' after key");
+    if (!next_token())
+        parse_error("Unexpected end: incomplete value for key");
+}
+
+void reader::finish_value()
+{
+    if (_frames.empty())
+        _root_finished = true;
+    else
+        _frames.back().need_separator = true;
+}
+
+reader::event reader::finish_document()
+{
+    if (_event != event::end && _options.complete_parse())
+    {
+        while (next_token())
+        {
+            // At the end of input, we might have a few nulls -- this is expected for string literals, so ignore them.
+            string_view text = _input.current().text;
+            if (std::any_of(text.begin(), text.end(), [] (char c) { return c != '\0'; }))
+                parse_error("Found non-trivial data after final token. ", _input.current().kind);
+        }
+    }
+    return _event = event::end;
+}
+
+reader::event reader::next_event()
+{
+    if (_after_key)
+    {
+        start_keyed_value();
+        return start_value();
+    }
+    
+    if (_frames.empty())
+    {
+        if (_root_finished)
+            return finish_document();
+        else if (!next_token())
+            parse_error("No input");
+        else
+            return start_value();
+    }
+    
+    frame& top = _frames.back();
+    const char* structure = top.object ? "object" : "array";
+    token_kind  end_kind  = top.object ? token_kind::object_end : token_kind::array_end;
+    if (!next_token())
+        parse_error("Unexpected end inside of ", structure);
+    
+    if (top.need_separator)
+    {
+        if (_input.current().kind == token_kind::separator)
+        {
+            top.need_separator = false;
+            top.after_comma    = true;
+            if (!next_token())
+                parse_error("Unexpected end inside of ", structure);
+        }
+        else if (_input.current().kind != end_kind)
+        {
+            parse_error("Invalid token while searching for the next value in ", structure);
+        }
+    }
+    
+    if (_input.current().kind == end_kind)
+    {
+        if (top.after_comma && _options.comma_policy() != parse_options::commas::allow_trailing)
+            parse_error("Trailing comma at end of ", structure);
+        _frames.pop_back();
+        finish_value();
+        return _event = end_kind == token_kind::object_end ? event::object_end : event::array_end;
+    }
+    
+    top.after_comma = false;
+    if (!top.object)
+        return start_value();
+    
+    if (_input.current().kind != token_kind::string)
+        parse_error("Expecting a key, but found ", _input.current().kind);
+    start_value();
+    // start_value finished the key like it was a value, but the actual value is still to come
+    top.need_separator = false;
+    _after_key         = true;
+    return _event      = event::key;
+}
+
+void reader::expect_event(event expected, const char* function) const
+{
+    if (_event != expected)
+    {
+        std::ostringstream os;
+        os << "Cannot call reader::" << function << " on " << _event << " (expecting " << expected << ")";
+        throw std::logic_error(os.str());
+    }
+}
+
+bool reader::as_boolean() const
+{
+    expect_event(event::boolean, "as_boolean");
+    return _boolean;
+}
+
+std::int64_t reader::as_integer() const
+{
+    expect_event(event::integer, "as_integer");
+    return _integer;
+}
+
+double reader::as_decimal() const
+{
+    if (_event == event::integer)
+        return double(_integer);
+    expect_event(event::decimal, "as_decimal");
+    return _decimal;
+}
+
+string_view reader::as_string() const
+{
+    if (_event == event::key)
+        return _string;
+    expect_event(event::string, "as_string");
+    return _string;
+}
+
+void reader::skip_value()
+{
+    switch (_event)
+    {
+    case event::key:
+        start_keyed_value();
+        // Skipping a single token is no faster than reading it, so only arrays and objects are actually skipped
+        start_value();
+        if (_event != event::array_begin && _event != event::object_begin)
+            return;
+        JSONV_FALLTHROUGH();
+    case event::array_begin:
+    case event::object_begin:
+        if (!_input.skip_structure())
+            parse_error("Unexpected end inside of skipped structure.");
+        _frames.pop_back();
+        finish_value();
+        _event = _event == event::array_begin ? event::array_end : event::object_end;
+        return;
+    case event::null:
+    case event::boolean:
+    case event::integer:
+    case event::decimal:
+    case event::string:
+        return;
+    default:
+    {
+        std::ostringstream os;
+        os << "Cannot call reader::skip_value on " << _event << ", which does not start a value";
+        throw std::logic_error(os.str());
+    }
+    }
+}
+
+value reader::read_value()
+{
+    switch (_event)
+    {
+    case event::key:
+        start_keyed_value();
+        break;
+    case event::array_begin:
+    case event::object_begin:
+        // parse_current will read the whole structure
+        _frames.pop_back();
+        break;
+    case event::null:    return null;
+    case event::boolean: return _boolean;
+    case event::integer: return _integer;
+    case event::decimal: return _decimal;
+    case event::string:  return std::string(_string);
+    default:
+    {
+        std::ostringstream os;
+        os << "Cannot call reader::read_value on " << _event << ", which does not start a value";
+        throw std::logic_error(os.str());
+    }
+    }
+    
+    const tokenizer::token& token = _input.current();
+    if (token.kind == token_kind::array_begin || token.kind == token_kind::object_begin)
+    {
+        _event = token.kind == token_kind::object_begin ? event::object_end : event::array_end;
+        // the structures this reader has open count toward the depth of the value
+        parse_options options = _options;
+        if (options.max_structure_depth() != 0)
+            options.max_structure_depth(options.max_structure_depth() - _frames.size());
+        value out = parse_current(_input, options);
+        finish_value();
+        return out;
+    }
+    else
+    {
+        // scalar values are decoded by start_value, which also sets everything up for next_event
+        start_value();
+        return read_value();
+    }
+}
+
+}
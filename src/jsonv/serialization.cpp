@@ -442,7 +442,7 @@ static formats create_default_formats()
                                              );
     fmt.register_adapter(&json_extractor);
 
-    static auto string_extractor = make_adapter([] (const value& from) { return from.as_string(); },
+    static auto string_extractor = make_adapter([] (const value& from) { return std::string(from.as_string_view()); },
                                                 [] (const std::string& from) { return value(from); }
                                                );
     fmt.register_adapter(&string_extractor);
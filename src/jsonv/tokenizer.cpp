@@ -9,6 +9,7 @@
  *  \author Travis Gockel (travis@gockelhut.com)
 **/
 #include <jsonv/tokenizer.hpp>
+#include <jsonv/detail/char_scan.hpp>
 #include <jsonv/detail/token_patterns.hpp>
 
 #include <algorithm>
@@ -111,41 +112,56 @@ void tokenizer::set_min_buffer_size(tokenizer::size_type sz)
 
 tokenizer::tokenizer(string_view input) :
         _input(input),
-        _position(_input.data())
-{ }
-
-tokenizer::tokenizer(std::shared_ptr<std::string> input) :
-        _input(*input),
         _position(_input.data()),
-        _track(std::move(input))
+        _current(),
+        _stream(nullptr),
+        _discarded(0),
+        _newlines_scanned(0),
+        _newlines_dropped(0),
+        _last_dropped_line(0)
 { }
 
-static std::string load_single_string(std::istream& input)
+tokenizer::tokenizer(std::istream& input) :
+        _input(),
+        _position(nullptr),
+        _current(),
+        _stream(&input),
+        _buffer(min_buffer_size()),
+        _discarded(0),
+        _newlines_scanned(0),
+        _newlines_dropped(0),
+        _last_dropped_line(0)
 {
-    std::string out;
-    char buffer[16 * 1024];
-
-    while (input.read(buffer, sizeof buffer))
-    {
-        out.append(buffer, sizeof buffer);
-    }
-    out.append(buffer, input.gcount());
-
-    return out;
+    _input = string_view(_buffer.data(), 0);
+    _position = _input.data();
 }
 
-tokenizer::tokenizer(std::istream& input) :
-        tokenizer(std::make_shared<std::string>(load_single_string(input)))
-{ }
-
 tokenizer::~tokenizer() noexcept
 { }
 
+void tokenizer::reset(string_view input)
+{
+    _input             = input;
+    _position          = _input.data();
+    _current           = token();
+    _stream            = nullptr;
+    _discarded         = 0;
+    _newlines.clear();
+    _newlines_scanned  = 0;
+    _newlines_dropped  = 0;
+    _last_dropped_line = 0;
+}
+
 const string_view& tokenizer::input() const
 {
     return _input;
 }
 
+bool tokenizer::input_is_stable() const
+{
+    return !_stream;
+}
+
 const tokenizer::token& tokenizer::current() const
 {
     if (_current.text.data())
@@ -156,34 +172,217 @@ const tokenizer::token& tokenizer::current() const
 
 bool tokenizer::next()
 {
-    auto valid = [this] (const string_view& new_current, token_kind new_kind)
+    auto valid = [this] (const string_view& new_current, token_kind new_kind, bool verbatim)
                  {
-                     _current.text = new_current;
-                     _current.kind = new_kind;
+                     _current.text     = new_current;
+                     _current.kind     = new_kind;
+                     _current.verbatim = verbatim;
                      return true;
                  };
     
     if (!_current.text.empty())
         _position += _current.text.size();
 
-    while (_position < _input.end())
+    while (_position < _input.end() || refill())
     {
         token_kind kind;
         size_type  match_len;
-        auto       result = detail::attempt_match(_position, _input.end(), *&kind, *&match_len);
+        bool       verbatim;
+        auto       result = detail::attempt_match(_position, _input.end(), *&kind, *&match_len, *&verbatim);
+
+        // A token which reaches the end of the buffered data (or stops one short of it, like a string ending in a
+        // backslash) might continue in the part of the stream which has not been read yet.
+        if (_stream && size_type(_input.end() - _position) <= match_len + 1 && refill())
+            continue;
 
         if (result == detail::match_result::unmatched)
         {
             // unmatched entry -- this token is invalid
             kind = kind | token_kind::parse_error_indicator;
         }
-        return valid(string_view(_position, match_len), kind);
+        return valid(string_view(_position, match_len), kind, verbatim);
     }
 
     return false;
 }
 
-void tokenizer::buffer_reserve(size_type)
-{ }
+bool tokenizer::refill()
+{
+    if (!_stream || !*_stream)
+        return false;
+    
+    // Everything before the current token has been consumed, but the current token itself must stay valid until the
+    // next call to next() returns.
+    const char* keep      = _current.text.data() ? _current.text.data() : _position;
+    size_type   keep_from = size_type(keep - _buffer.data());
+    size_type   kept      = _input.size() - keep_from;
+    size_type   position  = size_type(_position - keep);
+    
+    scan_newlines(_discarded + keep_from);
+    auto dropped_end = std::lower_bound(_newlines.begin(), _newlines.end(), _discarded + keep_from);
+    if (dropped_end != _newlines.begin())
+    {
+        _newlines_dropped  += size_type(dropped_end - _newlines.begin());
+        _last_dropped_line  = *(dropped_end - 1);
+        _newlines.erase(_newlines.begin(), dropped_end);
+    }
+    _discarded += keep_from;
+    
+    std::copy(_buffer.data() + keep_from, _buffer.data() + _input.size(), _buffer.data());
+    if (kept == _buffer.size())
+        _buffer.resize(_buffer.size() * 2);
+    
+    _stream->read(_buffer.data() + kept, std::streamsize(_buffer.size() - kept));
+    size_type read_count = size_type(_stream->gcount());
+    
+    _input    = string_view(_buffer.data(), kept + read_count);
+    _position = _buffer.data() + position;
+    if (_current.text.data())
+        _current.text = string_view(_buffer.data(), _current.text.size());
+    
+    return read_count > 0;
+}
+
+bool tokenizer::skip_structure()
+{
+    if (  !_current.text.data()
+       || (_current.kind != token_kind::array_begin && _current.kind != token_kind::object_begin)
+       )
+        throw std::logic_error("Can only skip a structure from its opening token.");
+    
+    enum class scan_state
+    {
+        structure,
+        string,
+        string_escape,
+        comment_start,
+        comment,
+        comment_asterisk,
+    };
+    
+    // Nothing before _position is needed anymore, so clearing the current token lets refill drop all of it
+    _position += _current.text.size();
+    _current   = token();
+    
+    scan_state state = scan_state::structure;
+    size_type  depth = 1;
+    do
+    {
+        for (const char* end = _input.end(); _position < end; )
+        {
+            switch (state)
+            {
+            case scan_state::structure:
+                switch (*_position)
+                {
+                case '\"':
+                    state = scan_state::string;
+                    break;
+                case '[':
+                case '{':
+                    ++depth;
+                    break;
+                case ']':
+                case '}':
+                    if (--depth == 0)
+                    {
+                        _current.text     = string_view(_position, 1);
+                        _current.kind     = *_position == ']' ? token_kind::array_end : token_kind::object_end;
+                        _current.verbatim = false;
+                        return true;
+                    }
+                    break;
+                case '/':
+                    state = scan_state::comment_start;
+                    break;
+                default:
+                    break;
+                }
+                ++_position;
+                break;
+            case scan_state::string:
+                _position = detail::scan_string_special(_position, end);
+                if (_position != end)
+                {
+                    state = *_position == '\"' ? scan_state::structure : scan_state::string_escape;
+                    ++_position;
+                }
+                break;
+            case scan_state::string_escape:
+                state = scan_state::string;
+                ++_position;
+                break;
+            case scan_state::comment_start:
+                // a '/' which does not start a comment is invalid, but that is not for this function to complain about
+                if (*_position == '*')
+                {
+                    state = scan_state::comment;
+                    ++_position;
+                }
+                else
+                {
+                    state = scan_state::structure;
+                }
+                break;
+            case scan_state::comment:
+                _position = std::find(_position, end, '*');
+                if (_position != end)
+                {
+                    state = scan_state::comment_asterisk;
+                    ++_position;
+                }
+                break;
+            case scan_state::comment_asterisk:
+                state = *_position == '/' ? scan_state::structure
+                      : *_position == '*' ? scan_state::comment_asterisk
+                      :                     scan_state::comment;
+                ++_position;
+                break;
+            }
+        }
+    } while (refill());
+    
+    return false;
+}
+
+void tokenizer::buffer_reserve(size_type sz)
+{
+    if (_stream && _buffer.size() < sz)
+    {
+        size_type keep_from = size_type(_input.data() - _buffer.data());
+        size_type position  = size_type(_position - _input.data());
+        size_type current   = _current.text.data() ? size_type(_current.text.data() - _input.data()) : 0;
+        
+        _buffer.resize(sz);
+        _input    = string_view(_buffer.data() + keep_from, _input.size());
+        _position = _input.data() + position;
+        if (_current.text.data())
+            _current.text = string_view(_input.data() + current, _current.text.size());
+    }
+}
+
+void tokenizer::scan_newlines(size_type offset)
+{
+    for ( ; _newlines_scanned < offset; ++_newlines_scanned)
+    {
+        char c = _input.data()[_newlines_scanned - _discarded];
+        if (c == '\n' || c == '\r')
+            _newlines.push_back(_newlines_scanned);
+    }
+}
+
+void tokenizer::locate(const char* position, size_type& line, size_type& column, size_type& character)
+{
+    size_type offset = _discarded + size_type(position - _input.data());
+    scan_newlines(offset);
+    
+    auto preceding = std::lower_bound(_newlines.begin(), _newlines.end(), offset);
+    size_type newlines_before = _newlines_dropped + size_type(preceding - _newlines.begin());
+    line      = 1 + newlines_before;
+    column    = newlines_before == 0             ? offset + 1
+              : preceding == _newlines.begin()   ? offset - _last_dropped_line
+              :                                    offset - *(preceding - 1);
+    character = offset;
+}
 
 }
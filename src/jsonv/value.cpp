@@ -20,8 +20,10 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <cstring>
 #include <iterator>
+#include <limits>
 #include <ostream>
 #include <sstream>
 
@@ -70,16 +72,53 @@ kind_error::~kind_error() noexcept
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 value::value(const std::string& val) :
-        _kind(jsonv::kind::null)
+        _fields(jsonv::kind::null)
 {
-    _data.string = new detail::string_impl;
-    _kind = jsonv::kind::string;
-    _data.string->_string = val;
+    init_string(val, nullptr);
+}
+
+value::value(std::string&& val) :
+        _fields(jsonv::kind::null)
+{
+    if (val.size() <= detail::short_string_fields::capacity)
+    {
+        init_string(val, nullptr);
+    }
+    else
+    {
+        _fields.data.string = detail::string_impl::create(nullptr);
+        _fields.kind = jsonv::kind::string;
+        _fields.data.string->_string = std::move(val);
+    }
 }
 
 value::value(const string_view& val) :
-        value(std::string(val))
-{ }
+        _fields(jsonv::kind::null)
+{
+    init_string(val, nullptr);
+}
+
+value::value(arena& region, const string_view& val) :
+        _fields(jsonv::kind::null)
+{
+    init_string(val, &region);
+}
+
+void value::init_string(string_view source, arena* region)
+{
+    if (source.size() <= detail::short_string_fields::capacity)
+    {
+        _short.kind      = jsonv::kind::string;
+        _short.short_tag = static_cast<unsigned char>(source.size() + 1);
+        std::memcpy(_short.data, source.data(), source.size());
+    }
+    else
+    {
+        _fields.data.string = detail::string_impl::create(region);
+        _fields.kind = jsonv::kind::string;
+        _fields.data.string->_string.assign(source.data(), source.size());
+    }
+}
 
 value::value(const char* val) :
         value(std::string(val))
@@ -94,15 +133,15 @@ value::value(const wchar_t* val) :
 { }
 
 value::value(int64_t val) :
-        _kind(jsonv::kind::integer)
+        _fields(jsonv::kind::integer)
 {
-    _data.integer = val;
+    _fields.data.integer = val;
 }
 
 value::value(double val) :
-        _kind(jsonv::kind::decimal)
+        _fields(jsonv::kind::decimal)
 {
-    _data.decimal = val;
+    _fields.data.decimal = val;
 }
 
 value::value(float val) :
@@ -110,16 +149,16 @@ value::value(float val) :
 { }
 
 value::value(bool val) :
-        _kind(jsonv::kind::boolean)
+        _fields(jsonv::kind::boolean)
 {
-    _data.boolean = val;
+    _fields.data.boolean = val;
 }
 
 #define JSONV_VALUE_INTEGER_ALTERNATIVE_CTOR_GENERATOR(type_)              \
     value::value(type_ val) :                                              \
-            _kind(jsonv::kind::integer)                                           \
+            _fields(jsonv::kind::integer)                                  \
     {                                                                      \
-        _data.integer = val;                                               \
+        _fields.data.integer = val;                                        \
     }
 JSONV_INTEGER_ALTERNATES_LIST(JSONV_VALUE_INTEGER_ALTERNATIVE_CTOR_GENERATOR)
 
@@ -128,28 +167,45 @@ value::~value() noexcept
     clear();
 }
 
+void value::copy_fields(const value& source) noexcept
+{
+    if (source._fields.short_tag == detail::borrowed_string_fields::tag)
+        _borrowed = source._borrowed;
+    else if (source.is_unowned_string())
+        _short = source._short;
+    else
+        _fields = source._fields;
+}
+
 value::value(const value& other) :
-        _kind(other._kind)
+        _fields(jsonv::kind::null)
 {
+    if (other.is_unowned_string())
+    {
+        copy_fields(other);
+        return;
+    }
+    
+    _fields.kind = other._fields.kind;
     switch (other.kind())
     {
     case jsonv::kind::object:
-        _data.object = other._data.object->clone();
+        _fields.data.object = other._fields.data.object->copy();
         break;
     case jsonv::kind::array:
-        _data.array = other._data.array->clone();
+        _fields.data.array = other._fields.data.array->copy();
         break;
     case jsonv::kind::string:
-        _data.string = other._data.string->clone();
+        _fields.data.string = other._fields.data.string->copy();
         break;
     case jsonv::kind::integer:
-        _data.integer = other._data.integer;
+        _fields.data.integer = other._fields.data.integer;
         break;
     case jsonv::kind::decimal:
-        _data.decimal = other._data.decimal;
+        _fields.data.decimal = other._fields.data.decimal;
         break;
     case jsonv::kind::boolean:
-        _data.boolean = other._data.boolean;
+        _fields.data.boolean = other._fields.data.boolean;
         break;
     case jsonv::kind::null:
         break;
@@ -164,11 +220,10 @@ value& value::operator=(const value& other)
 }
 
 value::value(value&& other) noexcept :
-        _data(other._data),
-        _kind(other._kind)
+        _fields(jsonv::kind::null)
 {
-    other._data.object = 0;
-    other._kind = jsonv::kind::null;
+    copy_fields(other);
+    other._fields = detail::value_fields(jsonv::kind::null);
 }
 
 value& value::operator=(value&& source) noexcept
@@ -177,10 +232,8 @@ value& value::operator=(value&& source) noexcept
     {
         clear();
         
-        _data = source._data;
-        _kind = source._kind;
-        source._data.object = 0;
-        source._kind = jsonv::kind::null;
+        copy_fields(source);
+        source._fields = detail::value_fields(jsonv::kind::null);
     }
     
     return *this;
@@ -221,34 +274,6 @@ bool value::is_object() const
     return kind() == jsonv::kind::object;
 }
 
-template <typename TValueRef, typename TPathIterator, typename FOnNonexistantPath>
-TValueRef walk_path(TValueRef&&               current,
-                    TPathIterator             first,
-                    TPathIterator             last,
-                    const FOnNonexistantPath& on_nonexistant_path
-                   )
-{
-    if (first == last)
-        return current;
-    
-    const path_element& elem = *first;
-    switch (elem.kind())
-    {
-    case path_element_kind::array_index:
-        check_type({ jsonv::kind::array, jsonv::kind::null }, current.kind());
-        if (current.kind() != jsonv::kind::array || elem.index() >= current.size())
-            on_nonexistant_path(elem, current);
-        return walk_path(current.at(elem.index()), std::next(first), last, on_nonexistant_path);
-    case path_element_kind::object_key:
-        check_type({ jsonv::kind::object, jsonv::kind::null }, current.kind());
-        if (current.kind() != jsonv::kind::object || !current.count(elem.key()))
-            on_nonexistant_path(elem, current);
-        return walk_path(current.at(elem.key()), std::next(first), last, on_nonexistant_path);
-    default:
-        throw std::runtime_error(to_string(elem));
-    }
-}
-
 value& value::at_path(const jsonv::path& p)
 {
     return walk_path(*this,
@@ -361,25 +386,32 @@ value::size_type value::count_path(size_type p) const
 
 void value::swap(value& other) noexcept
 {
-    using std::swap;
-    
-    // All types of this union a trivially swappable
-    swap(_data, other._data);
-    swap(_kind, other._kind);
+    // All types of this union are trivially copyable
+    value temp;
+    temp.copy_fields(*this);
+    copy_fields(other);
+    other.copy_fields(temp);
+    temp._fields = detail::value_fields(jsonv::kind::null);
 }
 
 void value::clear()
 {
-    switch (_kind)
+    if (is_unowned_string())
+    {
+        _fields = detail::value_fields(jsonv::kind::null);
+        return;
+    }
+    
+    switch (_fields.kind)
     {
     case jsonv::kind::object:
-        delete _data.object;
+        detail::object_impl::release(_fields.data.object);
         break;
     case jsonv::kind::array:
-        delete _data.array;
+        detail::array_impl::release(_fields.data.array);
         break;
     case jsonv::kind::string:
-        delete _data.string;
+        detail::string_impl::release(_fields.data.string);
         break;
     case jsonv::kind::integer:
     case jsonv::kind::decimal:
@@ -389,45 +421,83 @@ void value::clear()
         break;
     }
     
-    _kind = jsonv::kind::null;
-    _data.object = 0;
+    _fields = detail::value_fields(jsonv::kind::null);
+}
+
+void value::enable_sharing()
+{
+    if (is_unowned_string())
+        return;
+    
+    switch (_fields.kind)
+    {
+    case jsonv::kind::object:
+        if (_fields.data.object->shared())
+            return;
+        _fields.data.object->enable_sharing();
+        for (auto& entry : _fields.data.object->_values)
+            entry.second.enable_sharing();
+        break;
+    case jsonv::kind::array:
+        if (_fields.data.array->shared())
+            return;
+        _fields.data.array->enable_sharing();
+        for (value& sub : _fields.data.array->_values)
+            sub.enable_sharing();
+        break;
+    case jsonv::kind::string:
+        if (!_fields.data.string->shared())
+            _fields.data.string->enable_sharing();
+        break;
+    case jsonv::kind::integer:
+    case jsonv::kind::decimal:
+    case jsonv::kind::boolean:
+    case jsonv::kind::null:
+        // nothing to share
+        break;
+    }
 }
 
-const std::string& value::as_string() const
+std::string value::as_string() const
 {
-    check_type(jsonv::kind::string, _kind);
-    return _data.string->_string;
+    string_view contents = as_string_view();
+    return std::string(contents.data(), contents.size());
 }
 
 string_view value::as_string_view() const &
 {
-    check_type(jsonv::kind::string, _kind);
-    return string_view(_data.string->_string);
+    check_type(jsonv::kind::string, _fields.kind);
+    if (_fields.short_tag == detail::borrowed_string_fields::tag)
+        return string_view(_borrowed.data, _borrowed.length);
+    else if (is_unowned_string())
+        return string_view(_short.data, _short.short_tag - 1U);
+    else
+        return string_view(_fields.data.string->_string);
 }
 
 std::wstring value::as_wstring() const
 {
-    return detail::convert_to_wide(as_string());
+    return detail::convert_to_wide(as_string_view());
 }
 
 int64_t value::as_integer() const
 {
-    check_type(jsonv::kind::integer, _kind);
-    return _data.integer;
+    check_type(jsonv::kind::integer, _fields.kind);
+    return _fields.data.integer;
 }
 
 double value::as_decimal() const
 {
-    if (_kind == jsonv::kind::integer)
+    if (_fields.kind == jsonv::kind::integer)
         return double(as_integer());
-    check_type(jsonv::kind::decimal, _kind);
-    return _data.decimal;
+    check_type(jsonv::kind::decimal, _fields.kind);
+    return _fields.data.decimal;
 }
 
 bool value::as_boolean() const
 {
-    check_type(jsonv::kind::boolean, _kind);
-    return _data.boolean;
+    check_type(jsonv::kind::boolean, _fields.kind);
+    return _fields.data.boolean;
 }
 
 bool value::operator==(const value& other) const
@@ -496,11 +566,11 @@ bool value::empty() const noexcept
     switch (kind())
     {
     case jsonv::kind::object:
-        return _data.object->empty();
+        return _fields.data.object->empty();
     case jsonv::kind::array:
-        return _data.array->empty();
+        return _fields.data.array->empty();
     case jsonv::kind::string:
-        return _data.string->_string.empty();
+        return as_string_view().empty();
     case jsonv::kind::null:
         return true; // by definition a null value is empty
     case jsonv::kind::integer:
@@ -520,11 +590,11 @@ value::size_type value::size() const
     switch (kind())
     {
     case jsonv::kind::object:
-        return _data.object->size();
+        return _fields.data.object->size();
     case jsonv::kind::array:
-        return _data.array->size();
+        return _fields.data.array->size();
     case jsonv::kind::string:
-        return _data.string->_string.size();
+        return as_string_view().size();
     case jsonv::kind::integer:
     case jsonv::kind::decimal:
     case jsonv::kind::boolean:
@@ -545,6 +615,21 @@ value value::map(const std::function<value (value)>& func) &&
     return jsonv::map(func, std::move(*this));
 }
 
+value borrowed_string(string_view source)
+{
+    if (  source.size() <= detail::short_string_fields::capacity
+       || source.size() > std::numeric_limits<std::uint32_t>::max()
+       )
+        return value(source);
+    
+    value x;
+    x._borrowed.kind      = jsonv::kind::string;
+    x._borrowed.short_tag = detail::borrowed_string_fields::tag;
+    x._borrowed.length    = static_cast<std::uint32_t>(source.size());
+    x._borrowed.data      = source.data();
+    return x;
+}
+
 void swap(value& a, value& b) noexcept
 {
     a.swap(b);
@@ -559,6 +644,18 @@ const value null = value();
 namespace std
 {
 
+/** FNV-1a over the characters of \a text, which hashes a string without needing a \c std::string of it. **/
+static std::size_t hash_bytes(jsonv::string_view text)
+{
+    std::uint64_t x = 14695981039346656037ULL;
+    for (char c : text)
+    {
+        x ^= static_cast<unsigned char>(c);
+        x *= 1099511628211ULL;
+    }
+    return std::size_t(x);
+}
+
 template <typename TForwardIterator, typename FHasher>
 static std::size_t hash_range(TForwardIterator first, TForwardIterator last, const FHasher& hasher)
 {
@@ -584,7 +681,7 @@ size_t hash<jsonv::value>::operator()(const jsonv::value& val) const noexcept
     case jsonv::kind::array:
         return hash_range(val.begin_array(), val.end_array(), hash<jsonv::value>());
     case jsonv::kind::string:
-        return std::hash<std::string>()(val.as_string());
+        return hash_bytes(val.as_string_view());
     case jsonv::kind::integer:
         return std::hash<std::int64_t>()(val.as_integer());
     case jsonv::kind::decimal: